@@ -0,0 +1,89 @@
+// Elementwise products and remainders over many pairs, one operator call per
+// element against big_integer_batch, at every SIMD level this CPU supports
+// and with an optional thread pool. Times are nanoseconds per element.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp big_integer_batch.cpp -o big_integer_batch
+//   ./big_integer_batch [threads]
+
+#include "big_integer.h"
+#include "big_integer_batch.h"
+#include "limb_simd.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+static big_integer random_value(std::mt19937 &rng, size_t limbs)
+{
+    big_integer res;
+    for (size_t i = 0; i < limbs; ++i)
+    {
+        res <<= 32;
+        res += big_integer(static_cast<uint32_t>(rng()) | 1);
+    }
+    return res;
+}
+
+template <class F>
+static double time_per_element(F const &f, size_t count)
+{
+    size_t reps = 1;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reps; ++i) f();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > 0.2) return elapsed / reps / count * 1e9;
+        reps *= 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t threads = argc > 1 ? std::strtoul(argv[1], 0, 10) : 1;
+    std::unique_ptr<thread_pool> pool(threads > 1 ? new thread_pool(threads - 1) : 0);
+
+    size_t const count = 20000;
+    size_t const sizes[] = {2, 4, 8, 16};
+    char const *const levels[] = {"scalar", "avx2", "avx512"};
+
+    std::printf("%6s %8s %10s %10s %10s %10s\n", "limbs", "simd", "a*b", "batch mul", "a%m", "batch mod");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        std::mt19937 rng(static_cast<uint32_t>(sizes[s]));
+        std::vector<big_integer> a(count), b(count), out(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            a[i] = random_value(rng, sizes[s]);
+            b[i] = random_value(rng, sizes[s]);
+        }
+        big_integer m = random_value(rng, sizes[s] / 2 + 1);
+
+        for (int level = LIMB_SIMD_SCALAR; level <= limb_simd_supported(); ++level)
+        {
+            set_limb_simd_level(static_cast<limb_simd_level>(level));
+            double mul_loop = time_per_element([&]
+            {
+                for (size_t i = 0; i < count; ++i) out[i] = a[i] * b[i];
+            }, count);
+            double mul_batch = time_per_element([&]
+            {
+                big_integer_batch::mul(a, b, out, pool.get());
+            }, count);
+            double mod_loop = time_per_element([&]
+            {
+                for (size_t i = 0; i < count; ++i) out[i] = a[i] % m;
+            }, count);
+            double mod_batch = time_per_element([&]
+            {
+                big_integer_batch::mod(a, m, out, pool.get());
+            }, count);
+            std::printf("%6zu %8s %10.1f %10.1f %10.1f %10.1f\n", sizes[s], levels[level],
+                        mul_loop, mul_batch, mod_loop, mod_batch);
+        }
+    }
+    return 0;
+}
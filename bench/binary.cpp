@@ -0,0 +1,73 @@
+// Round trip of many values through to_string and the string constructor
+// against serialize_to and deserialize, and the time to point views at
+// every record of the serialized buffer.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp binary.cpp -o binary
+
+#include "big_integer.h"
+#include "big_integer_binary.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+template <class F>
+static double seconds(F const &f)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const limbs[] = {4, 64, 1024};
+    size_t const counts[] = {200000, 20000, 1000};
+    std::printf("%6s %8s %12s %12s %12s %12s\n", "limbs", "values", "decimal", "serialize", "deserialize", "views");
+    for (size_t s = 0; s < sizeof(limbs) / sizeof(limbs[0]); ++s)
+    {
+        std::vector<big_integer> values(counts[s]);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            for (size_t j = 0; j < limbs[s]; ++j)
+            {
+                values[i] <<= 32;
+                values[i] += big_integer(static_cast<uint32_t>(rng()));
+            }
+            if (rng() % 2 != 0) values[i] = -values[i];
+        }
+
+        std::vector<big_integer> back(values.size());
+        size_t const decimal_count = values.size() / 10;
+        double decimal = seconds([&] {
+            for (size_t i = 0; i < decimal_count; ++i) back[i] = big_integer(to_string(values[i]));
+        }) * 10;
+
+        std::vector<uint32_t> storage((values.size() * (limbs[s] + 1) * 4 + 3) / 4);
+        uint8_t *buf = reinterpret_cast<uint8_t *>(storage.data());
+        size_t size = storage.size() * 4, used = 0;
+        double ser = seconds([&] {
+            for (size_t i = 0; i < values.size(); ++i) used += serialize_to(values[i], buf + used, size - used);
+        });
+        double de = seconds([&] {
+            size_t at = 0;
+            for (size_t i = 0; i < values.size(); ++i) at += deserialize(buf + at, used - at, back[i]);
+        });
+        std::vector<big_integer_view> views(values.size());
+        double view = seconds([&] {
+            size_t at = 0;
+            for (size_t i = 0; i < values.size(); ++i) at += deserialize(buf + at, used - at, views[i]);
+        });
+
+        bool ok = true;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            ok = ok && back[i] == values[i] && views[i] == big_integer_view(values[i]);
+        }
+        std::printf("%6zu %8zu %10.2fms %10.2fms %10.2fms %10.2fms%s\n", limbs[s], values.size(), decimal * 1e3,
+                    ser * 1e3, de * 1e3, view * 1e3, ok ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Parsing and printing many short decimal values through from_chars and
+// to_chars, reusing one destination and one character buffer, against the
+// string constructor and to_string.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp chars.cpp -o chars
+
+#include "big_integer.h"
+#include "big_integer_chars.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+template <class F>
+static double seconds(F const &f)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const digits[] = {20, 40, 70, 300};
+    size_t const count = 200000;
+    std::printf("%7s %14s %14s %14s %14s\n", "digits", "string ctor", "from_chars", "to_string", "to_chars");
+    for (size_t d = 0; d < sizeof(digits) / sizeof(digits[0]); ++d)
+    {
+        std::vector<std::string> text(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            text[i].push_back(static_cast<char>('1' + rng() % 9));
+            for (size_t j = 1; j < digits[d]; ++j) text[i].push_back(static_cast<char>('0' + rng() % 10));
+        }
+
+        big_integer sum, value;
+        double ctor = seconds([&] {
+            for (size_t i = 0; i < count; ++i) sum += big_integer(text[i]);
+        });
+        double parse = seconds([&] {
+            for (size_t i = 0; i < count; ++i)
+            {
+                from_chars(text[i].data(), text[i].data() + text[i].size(), value);
+                sum -= value;
+            }
+        });
+
+        size_t length = 0;
+        double print = seconds([&] {
+            for (size_t i = 0; i < count; i += 4) length += to_string(big_integer(text[i])).size();
+        });
+        std::vector<char> buf(digits_upper_bound(big_integer(text[0])));
+        double format = seconds([&] {
+            for (size_t i = 0; i < count; i += 4)
+            {
+                from_chars(text[i].data(), text[i].data() + text[i].size(), value);
+                length -= static_cast<size_t>(to_chars(buf.data(), buf.data() + buf.size(), value).ptr - buf.data());
+            }
+        });
+        std::printf("%7zu %12.2fms %12.2fms %12.2fms %12.2fms%s\n", digits[d], ctor * 1e3, parse * 1e3, print * 1e3,
+                    format * 1e3, sum == 0 && length == 0 ? "" : "  MISMATCH");
+    }
+}
@@ -0,0 +1,74 @@
+// Cost of sharing one heap-backed value between threads: every thread
+// copies a common constant (bumping its link count), reads it, and every
+// eighth copy is written to, forcing the copy-on-write split. The plain
+// count is only timed on one thread; it is not safe to share.
+//
+//   g++ -O2 -pthread -I.. ../vector_with_opt.cpp ../limb_allocator.cpp cow_contention.cpp -o cow_contention
+//   ./cow_contention [max threads]
+
+#include "vector_with_opt.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+template <class V>
+static void worker(V const *shared, size_t iterations, uint32_t *sink)
+{
+    uint32_t acc = 0;
+    for (size_t it = 0; it < iterations; ++it)
+    {
+        V copy(*shared);
+        V const &view = copy;
+        acc += view[it % view.size()];
+        if (it % 8 == 0)
+        {
+            copy[0] += 1;
+            acc += copy[0];
+        }
+    }
+    *sink = acc;
+}
+
+template <class V>
+static double run(size_t limbs, size_t threads, size_t iterations)
+{
+    V shared;
+    for (size_t i = 0; i < limbs; ++i) shared.push_back(static_cast<uint32_t>(i));
+
+    std::vector<uint32_t> sinks(threads);
+    std::vector<std::thread> pool;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t)
+    {
+        pool.push_back(std::thread(worker<V>, &shared, iterations, &sinks[t]));
+    }
+    for (size_t t = 0; t < threads; ++t) pool[t].join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t sink = 0;
+    for (size_t t = 0; t < threads; ++t) sink += sinks[t];
+    if (sink == 42) std::printf(" ");
+    return elapsed * 1e9 / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    typedef basic_vector_with_opt<8, plain_link_count> plain_vector;
+    typedef basic_vector_with_opt<8, atomic_link_count> atomic_vector;
+
+    size_t const iterations = 2000000;
+    size_t const limbs = 64;
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (argc > 1) max_threads = std::strtoul(argv[1], 0, 10);
+    if (max_threads == 0) max_threads = 4;
+
+    std::printf("%-8s %8s %14s\n", "count", "threads", "ns/copy");
+    std::printf("%-8s %8d %12.1fns\n", "plain", 1, run<plain_vector>(limbs, 1, iterations));
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::printf("%-8s %8zu %12.1fns\n", "atomic", threads, run<atomic_vector>(limbs, threads, iterations));
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// The same arithmetic on fixed_big_integer and big_integer: a multiply-add
+// chain wrapped modulo 2^Bits (masked for big_integer), and divisions of
+// Bits-bit values by half-width ones.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp fixed.cpp -o fixed
+
+#include "big_integer.h"
+#include "fixed_big_integer.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+template <class F>
+static double seconds(F const &f)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static big_integer random_bits(std::mt19937 &rng, size_t bits)
+{
+    big_integer a;
+    for (size_t i = 0; i < bits; i += 32)
+    {
+        a <<= 32;
+        a += big_integer(static_cast<uint32_t>(rng()));
+    }
+    return a;
+}
+
+template <size_t Bits>
+static void run(std::mt19937 &rng, size_t count)
+{
+    typedef fixed_big_integer<Bits> fixed;
+    big_integer mask = (big_integer(1) << static_cast<int>(Bits)) - 1;
+    std::vector<big_integer> a(count), b(count);
+    std::vector<fixed> fa(count), fb(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = random_bits(rng, Bits);
+        b[i] = random_bits(rng, Bits / 2) + 1;
+        fa[i] = fixed(a[i]);
+        fb[i] = fixed(b[i]);
+    }
+
+    big_integer h = 1, q;
+    fixed fh = 1, fq;
+    double big_mul = seconds([&] {
+        for (size_t i = 0; i < count; ++i) h = (h * a[i] + b[i]) & mask;
+    });
+    double fixed_mul = seconds([&] {
+        for (size_t i = 0; i < count; ++i) fh = fh * fa[i] + fb[i];
+    });
+    double big_div = seconds([&] {
+        for (size_t i = 0; i < count; ++i) q += a[i] / b[i];
+    });
+    double fixed_div = seconds([&] {
+        for (size_t i = 0; i < count; ++i) fq += fa[i] / fb[i];
+    });
+    bool ok = fh.to_big_integer() == h && fq.to_big_integer() == (q & mask);
+    std::printf("%6zu %12.2fms %12.2fms %12.2fms %12.2fms%s\n", Bits, big_mul * 1e3, fixed_mul * 1e3, big_div * 1e3,
+                fixed_div * 1e3, ok ? "" : "  MISMATCH");
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const count = 200000;
+    std::printf("%6s %14s %14s %14s %14s\n", "bits", "big mul-add", "fixed mul-add", "big div", "fixed div");
+    run<128>(rng, count);
+    run<256>(rng, count);
+    run<512>(rng, count);
+    run<1024>(rng, count);
+}
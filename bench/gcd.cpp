@@ -0,0 +1,82 @@
+// gcd by Euclid's algorithm on operator% against gcd() and extended_gcd(),
+// for random operands of growing length. gcd() is also timed with the
+// half-gcd path switched off, which places gcd_tuning().gcd for this host.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp gcd.cpp -o gcd
+//   ./gcd [hgcd_threshold gcd_threshold]
+
+#include "big_integer.h"
+#include "gcd_engine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static big_integer random_value(std::mt19937 &rng, size_t limbs)
+{
+    big_integer res;
+    for (size_t i = 0; i < limbs; ++i)
+    {
+        res <<= 32;
+        res += big_integer(static_cast<uint32_t>(rng()));
+    }
+    return res;
+}
+
+static big_integer euclid(big_integer a, big_integer b)
+{
+    while (!b.is_zero())
+    {
+        big_integer r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+template <class F>
+static double seconds(F const &f)
+{
+    size_t reps = 1;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reps; ++i) f();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > 0.2) return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    gcd_thresholds &tuning = gcd_tuning();
+    if (argc > 2)
+    {
+        tuning.hgcd = std::strtoul(argv[1], 0, 10);
+        tuning.gcd = std::strtoul(argv[2], 0, 10);
+    }
+    gcd_thresholds const defaults = tuning;
+
+    std::mt19937 rng(1);
+    size_t const sizes[] = {4, 16, 64, 256, 1024, 4096, 16384};
+    std::printf("%6s %12s %12s %12s %12s\n", "limbs", "euclid", "lehmer", "gcd", "extended");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        big_integer a = random_value(rng, sizes[s]);
+        big_integer b = random_value(rng, sizes[s]);
+        big_integer expected, got;
+
+        double naive = sizes[s] <= 1024 ? seconds([&] { expected = euclid(a, b); }) : 0;
+        tuning.gcd = static_cast<size_t>(-1);
+        double lehmer = sizes[s] <= 4096 ? seconds([&] { got = gcd(a, b); }) : 0;
+        tuning = defaults;
+        double fast = seconds([&] { got = gcd(a, b); });
+        double ext = seconds([&] { extended_gcd(a, b); });
+
+        if (naive == 0) expected = got;
+        std::printf("%6zu %10.3fms %10.3fms %10.3fms %10.3fms%s\n", sizes[s], naive * 1e3, lehmer * 1e3,
+                    fast * 1e3, ext * 1e3, expected == got ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Runs a loop of short-lived temporaries (a quotient, a product and a sum
+// per step) under the heap, the thread-local pool and a big_integer_arena,
+// and prints the time and global-heap allocations per step.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp limb_allocators.cpp -o limb_allocators
+
+#include "big_integer.h"
+#include "limb_allocator.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+enum mode { HEAP, POOL, ARENA };
+
+static big_integer step(big_integer const &a, big_integer const &b, big_integer const &c)
+{
+    return a / b * c + a;
+}
+
+static void run(char const *name, mode m, big_integer const &a, big_integer const &b, big_integer const &c,
+                size_t iterations)
+{
+    limb_allocator *prev = set_limb_allocator(m == HEAP ? &heap_limb_allocator() : &pool_limb_allocator());
+    size_t heap_before = limb_allocation_stats().heap_allocations;
+    size_t sink = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; ++it)
+    {
+        if (m == ARENA)
+        {
+            big_integer_arena scope;
+            sink += step(a, b, c) > c;
+        }
+        else
+        {
+            sink += step(a, b, c) > c;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t heap = limb_allocation_stats().heap_allocations - heap_before;
+    set_limb_allocator(prev);
+
+    if (sink == 42) std::printf(" ");
+    std::printf("%-6s %10.1fns %12.2f\n", name, elapsed * 1e9 / iterations, double(heap) / iterations);
+}
+
+int main()
+{
+    big_integer a(std::string(400, '7'));
+    big_integer b(std::string(150, '3'));
+    big_integer c(std::string(120, '9'));
+    size_t const iterations = 100000;
+
+    std::printf("%-6s %12s %12s\n", "alloc", "time/step", "heap/step");
+    run("heap", HEAP, a, b, c, iterations);
+    run("pool", POOL, a, b, c, iterations);
+    run("arena", ARENA, a, b, c, iterations);
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Times the dispatched linear kernels at every SIMD level this CPU
+// supports, in nanoseconds per limb.
+//
+//   g++ -O2 -I.. ../limb_ops.cpp ../limb_simd.cpp limb_simd.cpp -o limb_simd
+
+#include "limb_ops.h"
+#include "limb_simd.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+enum kernel { ADD, SUB, AND, LSHIFT, CMP, KERNELS };
+
+static char const *const names[KERNELS] = {"add", "sub", "and", "lshift", "cmp"};
+
+static double run(kernel k, size_t n, size_t iterations)
+{
+    std::mt19937 rng(1);
+    std::vector<uint32_t> a(n), b(n), r(n + 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<uint32_t>(rng());
+        b[i] = a[i];
+    }
+    b[0] ^= 1;
+
+    uint32_t sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; ++it)
+    {
+        switch (k)
+        {
+        case ADD:
+            sink += limbs_add(&r[0], &a[0], n, &b[0], n);
+            break;
+        case SUB:
+            sink += limbs_sub(&r[0], &a[0], n, &b[0], n);
+            break;
+        case AND:
+            limbs_and_n(&r[0], &a[0], &b[0], n);
+            break;
+        case LSHIFT:
+            sink += limbs_lshift(&r[0], &a[0], n, 7);
+            break;
+        default:
+            sink += static_cast<uint32_t>(limbs_cmp(&a[0], n, &b[0], n));
+            break;
+        }
+        sink += r[it % n];
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 42) std::printf(" ");
+    return elapsed * 1e9 / (static_cast<double>(iterations) * n);
+}
+
+int main()
+{
+    static char const *const levels[] = {"scalar", "avx2", "avx512"};
+    limb_simd_level top = limb_simd_supported();
+
+    for (size_t n = 64; n <= 16384; n *= 16)
+    {
+        std::printf("%zu limbs\n%-8s", n, "");
+        for (int l = LIMB_SIMD_SCALAR; l <= top; ++l) std::printf("%10s", levels[l]);
+        std::printf("\n");
+        for (int k = 0; k < KERNELS; ++k)
+        {
+            std::printf("%-8s", names[k]);
+            for (int l = LIMB_SIMD_SCALAR; l <= top; ++l)
+            {
+                set_limb_simd_level(static_cast<limb_simd_level>(l));
+                std::printf("%10.3f", run(static_cast<kernel>(k), n, (1 << 24) / n));
+            }
+            std::printf("\n");
+        }
+    }
+    set_limb_simd_level(top);
+    return 0;
+}
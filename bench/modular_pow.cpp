@@ -0,0 +1,73 @@
+// Modular exponentiation by square-and-multiply with operator*= and
+// operator%= against modular_context::pow_mod, for an odd (Montgomery) and
+// an even (Barrett) modulus with a full-size exponent.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp modular_pow.cpp -o modular_pow
+
+#include "big_integer.h"
+#include "modular_context.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+static big_integer random_value(std::mt19937 &rng, size_t bits)
+{
+    big_integer res;
+    for (size_t i = 0; i < bits; i += 32)
+    {
+        res <<= 32;
+        res += big_integer(static_cast<uint32_t>(rng()));
+    }
+    return res | (big_integer(1) << static_cast<int>(bits - 1));
+}
+
+static big_integer naive_pow_mod(big_integer const &a, big_integer const &e, big_integer const &m)
+{
+    big_integer res = 1;
+    int bits = 0;
+    while ((e >> bits) != 0) ++bits;
+    for (int i = bits - 1; i >= 0; --i)
+    {
+        res *= res;
+        res %= m;
+        if (((e >> i) & 1) != 0)
+        {
+            res *= a;
+            res %= m;
+        }
+    }
+    return res;
+}
+
+template <class F>
+static double seconds(F const &f)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const sizes[] = {512, 1024, 2048, 4096};
+    std::printf("%6s %6s %12s %12s\n", "bits", "m", "naive", "context");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        for (int odd = 1; odd >= 0; --odd)
+        {
+            big_integer m = random_value(rng, sizes[s]);
+            m = odd ? (m | 1) : (m & ~big_integer(1));
+            big_integer a = random_value(rng, sizes[s] - 1);
+            big_integer e = random_value(rng, sizes[s]);
+            modular_context ctx(m);
+
+            big_integer expected, got;
+            double naive = seconds([&] { expected = naive_pow_mod(a, e, m); });
+            double fast = seconds([&] { got = ctx.pow_mod(a, e); });
+            std::printf("%6zu %6s %10.2fms %10.2fms%s\n", sizes[s], odd ? "odd" : "even",
+                        naive * 1e3, fast * 1e3, expected == got ? "" : "  MISMATCH");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Scaling of mul_limbs with mul_parallel().threads for a Toom-3 sized and an
+// NTT sized product, as time per product and speedup over one thread.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp mul_parallel.cpp -o mul_parallel
+//   ./mul_parallel [max threads]
+
+#include "mul_engine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+static double time_mul(size_t n)
+{
+    std::mt19937 rng(static_cast<uint32_t>(n));
+    std::vector<uint32_t> a(n), b(n), r(2 * n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<uint32_t>(rng());
+        b[i] = static_cast<uint32_t>(rng());
+    }
+
+    size_t reps = 1;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reps; ++i)
+        {
+            mul_limbs(&r[0], &a[0], n, &b[0], n);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > 0.2) return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], 0, 10) : std::thread::hardware_concurrency();
+    if (max_threads == 0) max_threads = 1;
+
+    size_t const sizes[] = {20000, 200000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        std::printf("%zu limbs\n%8s %12s %8s\n", sizes[s], "threads", "time", "speedup");
+        double base = 0;
+        for (size_t t = 1; t <= max_threads; ++t)
+        {
+            mul_parallel().threads = t;
+            double elapsed = time_mul(sizes[s]);
+            if (t == 1) base = elapsed;
+            std::printf("%8zu %10.2fms %7.2fx\n", t, elapsed * 1e3, base / elapsed);
+        }
+    }
+    return 0;
+}
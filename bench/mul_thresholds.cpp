@@ -0,0 +1,120 @@
+// Measures where Karatsuba overtakes schoolbook, Toom-3 overtakes Karatsuba
+// and the NTT overtakes Toom-3 on this host, for products and for squares,
+// and prints values for mul_tuning() and sqr_tuning().
+//
+//   g++ -O2 -pthread -I.. ../*.cpp mul_thresholds.cpp -o mul_thresholds
+
+#include "mul_engine.h"
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+typedef void (*mul_fn)(uint32_t *, uint32_t const *, size_t, uint32_t const *, size_t);
+
+static double time_mul(mul_fn fn, size_t n)
+{
+    std::mt19937 rng(static_cast<uint32_t>(n));
+    std::vector<uint32_t> a(n), b(n), r(2 * n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = static_cast<uint32_t>(rng());
+        b[i] = static_cast<uint32_t>(rng());
+    }
+
+    size_t reps = 1;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reps; ++i)
+        {
+            fn(&r[0], &a[0], n, &b[0], n);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > 0.05) return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+// The squaring forms behind the product signature; b is ignored.
+static void schoolbook_sqr(uint32_t *r, uint32_t const *a, size_t n, uint32_t const *, size_t)
+{
+    sqr_schoolbook(r, a, n);
+}
+
+static void karatsuba_sqr(uint32_t *r, uint32_t const *a, size_t n, uint32_t const *, size_t)
+{
+    sqr_karatsuba(r, a, n);
+}
+
+static void toom3_sqr(uint32_t *r, uint32_t const *a, size_t n, uint32_t const *, size_t)
+{
+    sqr_toom3(r, a, n);
+}
+
+static void ntt_sqr(uint32_t *r, uint32_t const *a, size_t n, uint32_t const *, size_t)
+{
+    sqr_ntt(r, a, n);
+}
+
+// Smallest size in [lo, hi) from which fast beats slow at every measured size.
+static size_t crossover(mul_fn slow, mul_fn fast, char const *slow_name, char const *fast_name,
+                        size_t lo, size_t hi, size_t step)
+{
+    std::printf("%8s %14s %14s\n", "limbs", slow_name, fast_name);
+    size_t found = hi;
+    for (size_t n = lo; n < hi; n += step)
+    {
+        double ts = time_mul(slow, n);
+        double tf = time_mul(fast, n);
+        std::printf("%8zu %12.2fus %12.2fus\n", n, ts * 1e6, tf * 1e6);
+        if (tf < ts)
+        {
+            if (found == hi) found = n;
+        }
+        else
+        {
+            found = hi;
+        }
+    }
+    return found;
+}
+
+// Places the three crossovers one after another, each with the ones below
+// it already set in tuning.
+static mul_thresholds measure(mul_thresholds &tuning, mul_fn schoolbook, mul_fn karatsuba, mul_fn toom3, mul_fn ntt)
+{
+    // Keep the subproducts on schoolbook so only the top level differs.
+    tuning.karatsuba = std::numeric_limits<size_t>::max();
+    tuning.toom3 = std::numeric_limits<size_t>::max();
+    tuning.ntt = std::numeric_limits<size_t>::max();
+    tuning.karatsuba = crossover(schoolbook, karatsuba, "schoolbook", "karatsuba", 8, 128, 4);
+    tuning.toom3 = crossover(karatsuba, toom3, "karatsuba", "toom3", 2 * tuning.karatsuba, 40 * tuning.karatsuba,
+                             2 * tuning.karatsuba);
+    tuning.ntt = crossover(toom3, ntt, "toom3", "ntt", 250, 4250, 250);
+    return tuning;
+}
+
+static void report(char const *name, mul_thresholds const &current, mul_thresholds const &host)
+{
+    std::printf("%s current: karatsuba = %zu, toom3 = %zu, ntt = %zu\n", name, current.karatsuba, current.toom3,
+                current.ntt);
+    std::printf("%s host:    karatsuba = %zu, toom3 = %zu, ntt = %zu\n", name, host.karatsuba, host.toom3, host.ntt);
+}
+
+int main()
+{
+    mul_thresholds const mul_defaults = mul_tuning();
+    mul_thresholds const sqr_defaults = sqr_tuning();
+
+    std::printf("products\n");
+    mul_thresholds mul = measure(mul_tuning(), mul_schoolbook, mul_karatsuba, mul_toom3, mul_ntt);
+    std::printf("\nsquares\n");
+    mul_thresholds sqr = measure(sqr_tuning(), schoolbook_sqr, karatsuba_sqr, toom3_sqr, ntt_sqr);
+
+    std::printf("\n");
+    report("mul", mul_defaults, mul);
+    report("sqr", sqr_defaults, sqr);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Conversion of one large value in bases 10, 16 and 2 through to_string
+// and from_string, and through operator<< and operator>> on a string
+// stream (which carries its own copy of the text).
+//
+//   g++ -O2 -pthread -I.. ../*.cpp radix.cpp -o radix
+
+#include "big_integer.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+
+template <class F>
+static double seconds(F const &f)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const limbs[] = {100, 10000, 100000};
+    int const bases[] = {10, 16, 2};
+    std::printf("%7s %5s %10s %12s %12s %12s %12s\n", "limbs", "base", "digits", "to_string", "from_string",
+                "ostream", "istream");
+    for (size_t s = 0; s < sizeof(limbs) / sizeof(limbs[0]); ++s)
+    {
+        big_integer a;
+        for (size_t j = 0; j < limbs[s]; ++j)
+        {
+            a <<= 32;
+            a += big_integer(static_cast<uint32_t>(rng()));
+        }
+
+        for (size_t b = 0; b < sizeof(bases) / sizeof(bases[0]); ++b)
+        {
+            int base = bases[b];
+            std::ios_base::fmtflags field = base == 16 ? std::ios_base::hex : std::ios_base::dec;
+            if (base == 2 && limbs[s] > 10000) continue;
+
+            std::string text;
+            big_integer back;
+            double out = seconds([&] { text = to_string(a, base); });
+            double in = seconds([&] { from_string(text, base, back); });
+            bool ok = back == a;
+
+            double stream_out = 0, stream_in = 0;
+            if (base != 2)
+            {
+                std::stringstream ss;
+                ss.setf(field, std::ios_base::basefield);
+                stream_out = seconds([&] { ss << a; });
+                stream_in = seconds([&] { ss >> back; });
+                ok = ok && back == a;
+            }
+            std::printf("%7zu %5d %10zu %10.2fms %10.2fms %10.2fms %10.2fms%s\n", limbs[s], base, text.size(),
+                        out * 1e3, in * 1e3, stream_out * 1e3, stream_in * 1e3, ok ? "" : "  MISMATCH");
+        }
+    }
+}
@@ -0,0 +1,99 @@
+// pow, isqrt and iroot against the same algorithms written with the
+// generic operators: square-and-multiply with operator*=, and Newton's
+// iteration from a power of two above the root at full precision every
+// step. is_perfect_power is timed on a perfect and a non-perfect power.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp roots.cpp -o roots
+
+#include "big_integer.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+static big_integer random_value(std::mt19937 &rng, size_t limbs)
+{
+    big_integer res;
+    for (size_t i = 0; i < limbs; ++i)
+    {
+        res <<= 32;
+        res += big_integer(static_cast<uint32_t>(rng()));
+    }
+    return res;
+}
+
+static big_integer naive_pow(big_integer const &a, uint32_t e)
+{
+    big_integer res = 1;
+    for (int i = 31; i >= 0; --i)
+    {
+        res *= res;
+        if ((e >> i & 1) != 0) res *= a;
+    }
+    return res;
+}
+
+static big_integer naive_root(big_integer const &a, uint32_t k)
+{
+    int bits = 0;
+    while ((a >> bits) != 0) ++bits;
+    big_integer x = big_integer(1) << ((bits + static_cast<int>(k) - 1) / static_cast<int>(k));
+    for (;;)
+    {
+        big_integer y = (x * (k - 1) + a / naive_pow(x, k - 1)) / k;
+        if (y >= x) return x;
+        x = y;
+    }
+}
+
+template <class F>
+static double seconds(F const &f)
+{
+    size_t reps = 1;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reps; ++i) f();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > 0.2) return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const sizes[] = {16, 128, 1024, 8192};
+    std::printf("%6s %-8s %12s %12s\n", "limbs", "op", "naive", "library");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        size_t n = sizes[s];
+        big_integer base = random_value(rng, n / 16);
+        big_integer a = random_value(rng, n);
+        big_integer expected, got;
+
+        double naive = seconds([&] { expected = naive_pow(base, 16); });
+        double fast = seconds([&] { got = pow(base, 16); });
+        std::printf("%6zu %-8s %10.3fms %10.3fms%s\n", n, "pow", naive * 1e3, fast * 1e3,
+                    expected == got ? "" : "  MISMATCH");
+
+        uint32_t const ks[] = {2, 3, 7};
+        for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]); ++i)
+        {
+            naive = n <= 1024 ? seconds([&] { expected = naive_root(a, ks[i]); }) : 0;
+            fast = seconds([&] { got = ks[i] == 2 ? isqrt(a) : iroot(a, ks[i]); });
+            if (naive == 0) expected = got;
+            char name[16];
+            std::snprintf(name, sizeof(name), "root %u", ks[i]);
+            std::printf("%6zu %-8s %10.3fms %10.3fms%s\n", n, name, naive * 1e3, fast * 1e3,
+                        expected == got ? "" : "  MISMATCH");
+        }
+
+        big_integer square = pow(random_value(rng, n / 2), 2);
+        bool perfect = false, other = true;
+        double yes = seconds([&] { perfect = is_perfect_power(square); });
+        double no = seconds([&] { other = is_perfect_power(a); });
+        std::printf("%6zu %-8s %10.3fms %10.3fms%s\n", n, "perfect", yes * 1e3, no * 1e3,
+                    perfect && !other ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// a * b against a * a for n-limb operands: the squaring kernels against
+// the general product at every algorithm's range, and x *= x through
+// big_integer against x *= y.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp sqr.cpp -o sqr
+
+#include "big_integer.h"
+#include "mul_engine.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+template <class F>
+static double seconds(F const &f)
+{
+    size_t reps = 1;
+    for (;;)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < reps; ++i) f();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed > 0.1) return elapsed / reps;
+        reps *= 2;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    size_t const sizes[] = {8, 32, 64, 200, 1000, 4000, 20000};
+    std::printf("%6s %12s %12s %12s %12s\n", "limbs", "a * b", "sqr", "x *= y", "x *= x");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        size_t n = sizes[s];
+        std::vector<uint32_t> a(n), b(n), r(2 * n);
+        for (size_t i = 0; i < n; ++i) a[i] = b[i] = static_cast<uint32_t>(rng());
+        double mul = seconds([&] { mul_limbs(&r[0], &a[0], n, &b[0], n); });
+        double sqr = seconds([&] { sqr_limbs(&r[0], &a[0], n); });
+
+        big_integer x, y;
+        for (size_t i = 0; i < n; ++i)
+        {
+            x <<= 32;
+            x += big_integer(a[i]);
+        }
+        y = x + 0;
+        double mul_big = seconds([&] { big_integer t = x; t *= y; });
+        double sqr_big = seconds([&] { big_integer t = x; t *= t; });
+        std::printf("%6zu %10.2fus %10.2fus %10.2fus %10.2fus\n", n, mul * 1e6, sqr * 1e6, mul_big * 1e6,
+                    sqr_big * 1e6);
+    }
+    return 0;
+}
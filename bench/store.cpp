@@ -0,0 +1,64 @@
+// Rebuilding a table of factorials with operator*= against opening a store
+// file holding it and looking every entry up.
+//
+//   g++ -O2 -pthread -I.. ../*.cpp store.cpp -o store
+//   ./store [entries [path]]
+
+#include "big_integer.h"
+#include "big_integer_store.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+template <class F>
+static double seconds(F const &f)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t entries = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], 0, 10)) : 5000;
+    std::string path = argc > 2 ? argv[2] : "factorials.store";
+
+    std::vector<big_integer> table(entries);
+    double rebuild = seconds([&] {
+        big_integer f = 1;
+        for (uint32_t i = 0; i < entries; ++i)
+        {
+            if (i > 0) f *= big_integer(i);
+            table[i] = f;
+        }
+    });
+
+    big_integer_store_writer writer;
+    for (uint32_t i = 0; i < entries; ++i) writer.add(i, table[i]);
+    double write = seconds([&] { writer.write(path); });
+
+    big_integer_store store;
+    size_t limbs = 0;
+    bool ok = true;
+    double load = seconds([&] {
+        ok = store.open(path);
+        for (uint32_t i = 0; ok && i < entries; ++i)
+        {
+            big_integer_view v;
+            ok = store.find(i, v);
+            limbs += v.size;
+        }
+    });
+    for (uint32_t i = 0; ok && i < entries; i += entries / 16 + 1)
+    {
+        big_integer_view v;
+        ok = store.find(i, v) && v == big_integer_view(table[i]);
+    }
+
+    std::printf("%u factorials, %zu limbs\n", entries, limbs);
+    std::printf("rebuild %10.2fms\nwrite   %10.2fms\nopen and look up all %10.2fms%s\n", rebuild * 1e3,
+                write * 1e3, load * 1e3, ok ? "" : "  MISMATCH");
+    return 0;
+}
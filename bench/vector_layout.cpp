@@ -0,0 +1,162 @@
+// Compares the small-buffer vector_with_opt layouts against the previous
+// one (a single inline limb, otherwise a refcounted node that wraps a
+// std::vector) on the 1-8 limb values big_integer mostly holds.
+//
+//   g++ -O2 -I.. ../vector_with_opt.cpp ../limb_allocator.cpp vector_layout.cpp -o vector_layout
+
+#include "vector_with_opt.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// The layout vector_with_opt had before it became basic_vector_with_opt.
+struct legacy_vector_with_opt
+{
+    struct vector_with_link
+    {
+        std::vector<uint32_t> data;
+        size_t link_count;
+    };
+
+    union
+    {
+        vector_with_link *big_object;
+        uint32_t small_obj;
+    };
+    size_t v_size;
+    bool is_big_obj;
+
+    legacy_vector_with_opt() : small_obj(0), v_size(0), is_big_obj(false) {}
+
+    legacy_vector_with_opt(legacy_vector_with_opt const &other) : small_obj(0), v_size(0), is_big_obj(false)
+    {
+        *this = other;
+    }
+
+    ~legacy_vector_with_opt()
+    {
+        if (is_big_obj) safe_delete();
+    }
+
+    legacy_vector_with_opt &operator=(legacy_vector_with_opt const &other)
+    {
+        if (this == &other) return *this;
+        if (is_big_obj) safe_delete();
+        if (other.is_big_obj)
+        {
+            other.big_object->link_count++;
+            big_object = other.big_object;
+        }
+        else
+        {
+            small_obj = other.small_obj;
+        }
+        v_size = other.v_size;
+        is_big_obj = other.is_big_obj;
+        return *this;
+    }
+
+    uint32_t &operator[](size_t index)
+    {
+        if (!is_big_obj) return small_obj;
+        make_own_copy();
+        return big_object->data[index];
+    }
+
+    void push_back(uint32_t elem)
+    {
+        if (is_big_obj)
+        {
+            make_own_copy();
+            big_object->data.push_back(elem);
+        }
+        else if (v_size == 0)
+        {
+            small_obj = elem;
+        }
+        else
+        {
+            vector_with_link *v = new vector_with_link;
+            v->data.push_back(small_obj);
+            v->data.push_back(elem);
+            v->link_count = 1;
+            big_object = v;
+            is_big_obj = true;
+        }
+        ++v_size;
+    }
+
+    void pop_back()
+    {
+        --v_size;
+        if (!is_big_obj) return;
+        make_own_copy();
+        big_object->data.pop_back();
+        if (v_size == 1)
+        {
+            uint32_t buff = big_object->data[0];
+            safe_delete();
+            is_big_obj = false;
+            small_obj = buff;
+        }
+    }
+
+    size_t size() const
+    {
+        return v_size;
+    }
+
+    void safe_delete()
+    {
+        if (big_object->link_count > 1) big_object->link_count--;
+        else delete big_object;
+    }
+
+    void make_own_copy()
+    {
+        if (big_object->link_count > 1)
+        {
+            vector_with_link *v = new vector_with_link;
+            v->data = big_object->data;
+            v->link_count = 1;
+            big_object->link_count--;
+            big_object = v;
+        }
+    }
+};
+
+// Builds a value, copies it, writes every limb of the copy (forcing the
+// copy-on-write split) and shrinks it again: what an arithmetic temporary
+// goes through.
+template <class V>
+static double run(size_t limbs, size_t iterations)
+{
+    uint32_t sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; ++it)
+    {
+        V v;
+        for (size_t i = 0; i < limbs; ++i) v.push_back(static_cast<uint32_t>(it + i));
+        V copy(v);
+        for (size_t i = 0; i < limbs; ++i) copy[i] += 1;
+        while (copy.size() > 1) copy.pop_back();
+        sink += copy[0] + v[0];
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 42) std::printf(" ");
+    return elapsed * 1e9 / iterations;
+}
+
+int main()
+{
+    size_t const iterations = 2000000;
+    std::printf("%6s %14s %14s %14s\n", "limbs", "legacy", "inline<4>", "inline<8>");
+    for (size_t limbs = 1; limbs <= 16; limbs *= 2)
+    {
+        std::printf("%6zu %12.1fns %12.1fns %12.1fns\n", limbs,
+                    run<legacy_vector_with_opt>(limbs, iterations),
+                    run<basic_vector_with_opt<4> >(limbs, iterations),
+                    run<basic_vector_with_opt<8> >(limbs, iterations));
+    }
+    return 0;
+}
@@ -1,8 +1,16 @@
 #include "big_integer.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include "div_engine.h"
+#include "gcd_engine.h"
+#include "power_engine.h"
+#include "big_integer_expr.h"
+#include "radix_conversion.h"
 #include <cstring>
 #include <stdexcept>
 #include <algorithm>
-#include <iostream>
+#include <istream>
+#include <ostream>
 
 using namespace std;
 
@@ -15,10 +23,13 @@ big_integer::big_integer()
     sign = true;
 }
 
-big_integer::big_integer(big_integer const &other)
+big_integer::big_integer(big_integer const &other) : sign(other.sign), data(other.data)
+{ }
+
+big_integer::big_integer(big_integer &&other) noexcept : sign(other.sign), data(std::move(other.data))
 {
-    this->data = other.data;
-    this->sign = other.sign;
+    other.data.push_back(0);
+    other.sign = true;
 }
 
 big_integer::big_integer(int a)
@@ -30,9 +41,7 @@ big_integer::big_integer(int a)
         sign = false;
         res = -res;
     }
-    data.push_back(static_cast<uint32_t>(res % BASE));
-    data.push_back(static_cast<uint32_t>((res / BASE) % BASE));
-    delete_zeroes();
+    data.push_back(static_cast<uint32_t>(res));
 }
 
 big_integer::big_integer(uint32_t a)
@@ -43,23 +52,7 @@ big_integer::big_integer(uint32_t a)
 
 big_integer::big_integer(std::string const &str) : big_integer()
 {
-    size_t begin_of_str = 0;
-
-    if (str[0] == '-')
-    {
-        this->sign = false;
-        begin_of_str = 1;
-    }
-
-    uint32_t digit;
-    for (size_t i = begin_of_str; i < str.size(); i++)
-    {
-        digit = static_cast<uint32_t>(str[i] - '0');
-        this->mul_long_short(10);
-        this->add_long_short(digit);
-    }
-
-    delete_zeroes();
+    from_string(str, 10, *this);
 }
 
 big_integer::~big_integer()
@@ -73,6 +66,19 @@ big_integer &big_integer::operator =(big_integer const &other)
     return *this;
 }
 
+big_integer &big_integer::operator =(big_integer &&other) noexcept
+{
+    if (this != &other)
+    {
+        this->data = std::move(other.data);
+        this->sign = other.sign;
+        other.data.push_back(0);
+        other.sign = true;
+    }
+
+    return *this;
+}
+
 big_integer &big_integer::operator +=(big_integer const &rhs)
 {
     if (this->sign == rhs.sign) return this->abs_add(rhs);
@@ -101,62 +107,44 @@ big_integer &big_integer::operator-=(big_integer const &rhs)
     }
 }
 
-big_integer &big_integer::abs_sub(big_integer rhs, bool swap)
+big_integer &big_integer::abs_sub(big_integer const &rhs, bool swap)
 {
-    big_integer *right_op;
-    big_integer *left_op;
-    uint32_t carry = 0;
-    uint32_t right;
-    uint32_t left;
-    uint32_t res;
-    size_t lim;
+    size_t n = this->data.size();
+    size_t m = rhs.data.size();
 
     if (!swap)
     {
-        left_op = this;
-        right_op = &rhs;
-        lim = rhs.data.size();
+        uint32_t *r = this->data.mutable_data();
+        limbs_sub(r, r, n, rhs.data.data(), m);
     }
     else
     {
-        left_op = &rhs;
-        right_op = this;
-        lim = this->data.size();
-    }
-
-    for (size_t i = 0; i < lim || carry; i++)
-    {
-        left = (left_op->data[i]);
-        right = carry + (i < right_op->data.size() ? right_op->data[i] : 0);
-
-        if (left < right) {
-            carry = 1;
-            res = left + static_cast<uint32_t> (BASE - right);
-        }
-        else
-        {
-            carry = 0;
-            res = left - right;
-        }
-
-        this->data[i] = static_cast<uint32_t> (res);
+        this->data.resize(m);
+        uint32_t *r = this->data.mutable_data();
+        limbs_sub(r, rhs.data.data(), m, r, n);
     }
 
     delete_zeroes();
+    this->sign = this->sign || is_zero();
     return *this;
 }
 
 big_integer &big_integer::abs_add(big_integer const &other)
 {
-    uint64_t carry = 0;
-    size_t const ma = std::max(this->data.size(), other.data.size());
-    for (size_t i = 0; i < ma || carry; i++)
+    size_t n = this->data.size();
+    size_t m = other.data.size();
+    size_t len = std::max(n, m);
+
+    this->data.resize(len + 1);
+    uint32_t *r = this->data.mutable_data();
+    uint32_t const *b = this == &other ? r : other.data.data();
+    if (n >= m)
+    {
+        r[len] = limbs_add(r, r, n, b, m);
+    }
+    else
     {
-        if (i == this->data.size()) this->data.push_back(0);
-        uint64_t a = static_cast<int64_t> (this->data[i]) +
-                     static_cast<int64_t> (i < other.data.size() ? other.data[i] : 0) + carry;
-        this->data[i] = static_cast<uint32_t> (a % BASE);
-        carry = a / BASE;
+        r[len] = limbs_add(r, b, m, r, n);
     }
 
     this->delete_zeroes();
@@ -165,251 +153,231 @@ big_integer &big_integer::abs_add(big_integer const &other)
 
 big_integer &big_integer::operator*=(big_integer const &rhs)
 {
-    this->sign = this->sign == rhs.sign;
-    if (rhs.data.size() == 1)
+    bool res_sign = this->sign == rhs.sign;
+    size_t n = this->data.size();
+    size_t m = rhs.data.size();
+
+    if (n == m && this->data.data() == rhs.data.data())
     {
-        this->mul_long_short(rhs.data[0]);
+        // rhs is *this or shares its limbs.
+        this->square_inplace();
+        this->sign = res_sign || is_zero();
         return *this;
     }
-
-    uint64_t t, mul_carry = 0, add_carry = 0;
-
-    for (std::ptrdiff_t i = this->data.size() - 1; i >= 0; i--)
+    if (m == 1)
     {
-        mul_carry = 0;
-        uint64_t mul = this->data[i];
-        for (size_t j = 0; j < rhs.data.size(); j++)
-        {
-            t = mul * static_cast<int64_t>(rhs.data[j]) + mul_carry;
-            mul_carry = t / BASE;
-            t = t % BASE;
-
-            if (j == 0) this->data[i] = 0;
-            size_t k = i + j;
-            if (k == this->data.size()) this->data.push_back(0);
-            uint64_t tmp2 = static_cast<uint64_t>(this->data[k]) + t;
-            add_carry = tmp2 / BASE;
-            tmp2 = tmp2 % BASE;
-
-            this->data[k] = static_cast<uint32_t> (tmp2);
-
-            while (add_carry != 0)
-            {
-                k++;
-                if (k == this->data.size()) this->data.push_back(0);
-                tmp2 = static_cast<uint64_t>(this->data[k]) + add_carry;
-                add_carry = tmp2 / BASE;
-                this->data[k] = static_cast<uint32_t> (tmp2 % BASE);
-            }
-        }
-
-        size_t k = i + rhs.data.size();
-        while (mul_carry != 0)
-        {
-            if (k == this->data.size()) this->data.push_back(0);
-            uint64_t tmp2 = static_cast<uint64_t>(this->data[k]) + mul_carry;
-            mul_carry = tmp2 / BASE;
-            this->data[k] = static_cast<uint32_t> (tmp2 % BASE);
-            k++;
-        }
+        this->mul_long_short(rhs.data[0]);
+    }
+    else
+    {
+        vector_with_opt res;
+        res.resize(n + m);
+        mul_limbs(res.mutable_data(), this->data.data(), n, rhs.data.data(), m);
+        this->data = std::move(res);
     }
-    delete_zeroes();
 
+    delete_zeroes();
+    this->sign = res_sign || is_zero();
     return *this;
 }
 
-big_integer &big_integer::operator/=(big_integer const &rhs)
+big_integer &big_integer::square_inplace()
 {
-    if (this->compare_by_abs(rhs) < 0)
+    size_t n = this->data.size();
+    if (n == 1)
     {
-        return *this = big_integer(0);
+        this->mul_long_short(this->data[0]);
     }
-
-    bool sign = this->sign == rhs.sign;
-
-    if (rhs.data.size() == 1)
+    else
     {
-        this->div_and_mod_by_short(rhs.data[0]);
-        this->sign = sign;
-        return *this;
+        vector_with_opt res;
+        res.resize(2 * n);
+        sqr_limbs(res.mutable_data(), this->data.data(), n);
+        this->data = std::move(res);
     }
 
+    delete_zeroes();
     this->sign = true;
-    big_integer divn(rhs);
-    divn.sign = true;
+    return *this;
+}
 
-    uint32_t normalize = static_cast<uint32_t> (BASE / (divn.data.back() + 1));
-    this->mul_long_short(normalize);
-    divn.mul_long_short(normalize);
+big_integer &big_integer::operator/=(big_integer const &rhs)
+{
+    big_integer rem;
+    return this->div_rem(rhs, rem);
+}
 
-    uint32_t cached = divn.data.back();
-    size_t n = divn.data.size();
-    size_t m = this->data.size() - divn.data.size();
+big_integer &big_integer::operator%=(big_integer const &rhs)
+{
+    big_integer quot(*this);
+    quot.div_rem(rhs, *this);
+    return *this;
+}
 
-    big_integer res;
-    res.data.resize(m + 1);
+big_integer &big_integer::div_rem(big_integer const &rhs, big_integer &rem)
+{
+    if (this->compare_by_abs(rhs) < 0)
+    {
+        rem = *this;
+        return *this = big_integer(0);
+    }
 
-    big_integer shifted(divn);
-    shifted <<= (m * 32);
+    bool res_sign = this->sign == rhs.sign;
+    bool rem_sign = this->sign;
+    size_t n = this->data.size();
+    size_t m = rhs.data.size();
 
-    if (*this >= shifted)
+    if (m == 1)
     {
-        res.data[m] = 1;
-        *this -= shifted;
+        uint32_t r = this->div_and_mod_by_short(rhs.data[0]);
+        rem = big_integer(r);
     }
     else
     {
-        res.data[m] = 0;
+        vector_with_opt q, r;
+        q.resize(n - m + 1);
+        r.resize(m);
+        div_limbs(q.mutable_data(), r.mutable_data(), this->data.data(), n, rhs.data.data(), m);
+        this->data = std::move(q);
+        rem.data = std::move(r);
+        rem.delete_zeroes();
     }
 
-    for (std::ptrdiff_t i = m - 1; i >= 0; --i)
+    delete_zeroes();
+    this->sign = res_sign || is_zero();
+    rem.sign = rem_sign || rem.is_zero();
+    return *this;
+}
+
+namespace
+{
+    struct and_op
     {
-        uint64_t cur = BASE * static_cast<int64_t>(this->data[n + i])
-                       + static_cast<int64_t>(this->data[n + i - 1]);
-        cur /= static_cast<int64_t>(cached);
-        if (cur > BASE - 1)
+        static uint32_t apply(uint32_t a, uint32_t b)
         {
-            cur = BASE - 1;
+            return a & b;
         }
-        res.data[i] = static_cast<uint32_t>(cur);
 
-        shifted >>= 32;
-        big_integer k = shifted * static_cast<uint32_t>(cur);
-        *this -= (k);
+        static void apply_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)
+        {
+            limbs_and_n(r, a, b, n);
+        }
+    };
 
-        while (*this < B_ZERO)
+    struct or_op
+    {
+        static uint32_t apply(uint32_t a, uint32_t b)
         {
-            res.data[i]--;
-            *this += shifted;
+            return a | b;
         }
 
-    }
+        static void apply_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)
+        {
+            limbs_ior_n(r, a, b, n);
+        }
+    };
 
-    *this = res;
-    this->sign = sign;
-    delete_zeroes();
+    struct xor_op
+    {
+        static uint32_t apply(uint32_t a, uint32_t b)
+        {
+            return a ^ b;
+        }
 
-    return *this;
-}
+        static void apply_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)
+        {
+            limbs_xor_n(r, a, b, n);
+        }
+    };
 
-big_integer &big_integer::operator%=(big_integer const &rhs)
-{
-    return *this -= ((*this / rhs) * rhs);
+    // Next limb of the two's complement ~(x - 1) of a magnitude, with mask
+    // all ones and borrow starting at 1; mask 0 and borrow 0 pass x through.
+    inline uint32_t twos_complement_limb(uint32_t x, uint32_t mask, uint32_t &borrow)
+    {
+        uint32_t d = x - borrow;
+        borrow = x < borrow;
+        return d ^ mask;
+    }
 }
 
-big_integer &big_integer::operator&=(big_integer const &rhs)
+// Applies Op to the two's-complement forms of both operands in one pass
+// over the magnitudes, negating inputs and the result limb by limb.
+template <class Op>
+big_integer &big_integer::bitwise(big_integer const &rhs)
 {
-    big_integer right_op(rhs);
-    uint32_t left, right;
+    size_t n = this->data.size();
+    size_t m = rhs.data.size();
+    size_t len = std::max(n, m);
+    // Zero is non-negative whatever its sign flag says.
+    uint32_t left_mask = this->sign || is_zero() ? 0 : LIMB_MAX;
+    uint32_t right_mask = rhs.sign || rhs.is_zero() ? 0 : LIMB_MAX;
+    uint32_t res_mask = Op::apply(left_mask, right_mask);
 
-    this->convert();
-    right_op.convert();
+    // One spare limb: the magnitude of a negative result can grow by one.
+    this->data.resize(len + 1);
+    uint32_t *r = this->data.mutable_data();
+    uint32_t const *b = this == &rhs ? r : rhs.data.data();
 
-    size_t end_of_digits = std::max(this->data.size(), right_op.data.size());
-    for (size_t i = 0; i < end_of_digits; ++i)
+    if (left_mask == 0 && right_mask == 0)
     {
-        left = (i < this->data.size() ? this->data[i] : (this->sign ? 0 : std::numeric_limits<uint32_t>::max()));
-        right = (i < right_op.data.size() ? right_op.data[i] : (right_op.sign ? 0 : std::numeric_limits<uint32_t>::max()));
-        if (i == this->data.size()) this->data.push_back(0);
-        this->data[i] = left & right;
+        size_t common = std::min(n, m);
+        Op::apply_n(r, r, b, common);
+        for (size_t i = common; i < m; ++i) r[i] = Op::apply(0, b[i]);
+        for (size_t i = m; i < n; ++i) r[i] = Op::apply(r[i], 0);
+    }
+    else
+    {
+        uint32_t left_borrow = left_mask & 1;
+        uint32_t right_borrow = right_mask & 1;
+        uint32_t res_borrow = res_mask & 1;
+        size_t i = 0;
+        for (; i < m; ++i)
+        {
+            uint32_t x = twos_complement_limb(r[i], left_mask, left_borrow);
+            uint32_t y = twos_complement_limb(b[i], right_mask, right_borrow);
+            r[i] = twos_complement_limb(Op::apply(x, y), res_mask, res_borrow);
+        }
+        for (; i <= len; ++i)
+        {
+            uint32_t x = twos_complement_limb(r[i], left_mask, left_borrow);
+            uint32_t y = twos_complement_limb(0, right_mask, right_borrow);
+            r[i] = twos_complement_limb(Op::apply(x, y), res_mask, res_borrow);
+        }
     }
 
-    this->sign = this->sign || right_op.sign;
-
-    this->convert();
     delete_zeroes();
-
+    this->sign = res_mask == 0 || is_zero();
     return *this;
 }
 
-big_integer &big_integer::operator|=(big_integer const &rhs)
+big_integer &big_integer::operator&=(big_integer const &rhs)
 {
-    big_integer right_op(rhs);
-    uint32_t left, right;
-
-    this->convert();
-    right_op.convert();
-
-    size_t end_of_digits = std::max(this->data.size(), right_op.data.size());
-
-    for (size_t i = 0; i < end_of_digits; ++i)
-    {
-        left = (i < this->data.size() ? this->data[i] : (this->sign ? 0 : std::numeric_limits<uint32_t>::max()));
-        right = (i < right_op.data.size() ? right_op.data[i] : (right_op.sign ? 0 : std::numeric_limits<uint32_t>::max()));
-        if (i == this->data.size()) this->data.push_back(0);
-        this->data[i] = left | right;
-    }
-
-    this->sign = this->sign && right_op.sign;
-
-    this->convert();
-    delete_zeroes();
+    return bitwise<and_op>(rhs);
+}
 
-    return *this;
+big_integer &big_integer::operator|=(big_integer const &rhs)
+{
+    return bitwise<or_op>(rhs);
 }
 
 big_integer &big_integer::operator^=(big_integer const &rhs)
 {
-    big_integer right_op(rhs);
-    uint32_t left, right;
-
-    right_op.convert();
-    this->convert();
-
-    size_t end_of_digits = std::max(this->data.size(), right_op.data.size());
-
-    for (size_t i = 0; i < end_of_digits; ++i)
-    {
-        left = (i < this->data.size() ? this->data[i] : (this->sign ? 0 : std::numeric_limits<uint32_t>::max()));
-        right = (i < right_op.data.size() ? right_op.data[i] : (right_op.sign ? 0 : std::numeric_limits<uint32_t>::max()));
-        if (i == this->data.size()) this->data.push_back(0);
-        this->data[i] = left ^ right;
-    }
-
-    this->sign = !(this->sign ^ right_op.sign);
-
-    this->convert();
-    delete_zeroes();
-
-    return *this;
+    return bitwise<xor_op>(rhs);
 }
 
 big_integer &big_integer::operator<<=(int rhs)
 {
     if (rhs == 0 || is_zero()) return *this;
     if (rhs < 0) return this->operator>>=(-rhs);
-    uint32_t blocks = static_cast<uint32_t>(rhs) / 32;
-    uint32_t bytes = static_cast<uint32_t>(rhs) % 32;
-    data.push_back(0);
 
-    if (bytes != 0)
-    {
-        for (size_t i = data.size() - 1; i > 0; --i)
-        {
-            uint32_t next, cur;
-            next = ~((1U << (32U - bytes)) - 1U);
-            next &= data[i - 1];
-            next >>= (32 - bytes);
+    size_t blocks = static_cast<uint32_t>(rhs) / 32;
+    unsigned bits = static_cast<uint32_t>(rhs) % 32;
+    size_t n = data.size();
 
-            cur = data[i - 1];
-            cur <<= bytes;
-
-            data[i - 1] = cur;
-            data[i] |= next;
-        }
-    }
-
-    size_t size0 = data.size();
-    data.resize(data.size() + blocks);
-
-    for (std::ptrdiff_t i = size0 + blocks - 1; i >= blocks; --i)
-    {
-        data[i] = data[i - blocks];
-    }
-    for (size_t i = 0; i < blocks; ++i)
-    {
-        data[i] = 0;
-    }
+    data.resize(n + blocks + 1);
+    uint32_t *p = data.mutable_data();
+    p[n + blocks] = limbs_lshift(p + blocks, p, n, bits);
+    std::fill(p, p + blocks, 0);
 
     delete_zeroes();
     return *this;
@@ -420,50 +388,32 @@ big_integer &big_integer::operator>>=(int rhs)
     if (rhs == 0 || is_zero()) return *this;
     if (rhs < 0) return this->operator<<=(-rhs);
 
-    uint32_t blocks = static_cast<uint32_t>(rhs) / 32;
-    uint32_t bytes = static_cast<uint32_t>(rhs) % 32;
+    size_t blocks = static_cast<uint32_t>(rhs) / 32;
+    unsigned bits = static_cast<uint32_t>(rhs) % 32;
+    size_t n = data.size();
 
-    this->convert();
-
-    if (bytes != 0)
+    if (blocks >= n)
     {
-        for (size_t i = blocks; i < data.size(); i++)
-        {
-            uint32_t cur, prev;
-            cur = data[i];
-            cur >>= bytes;
-
-            if (i == data.size() - 1 && !this->sign)
-            {
-                uint32_t mask = ~((1U << (32U - bytes)) - 1U);
-                cur |= mask;
-            }
-
-            data[i] = cur;
-            if (i < data.size() - 1)
-            {
-                prev = (1U << bytes) - 1;
-                prev &= data[i + 1];
-                prev <<= (32 - bytes);
-                data[i] |= prev;
-            }
-        }
+        return *this = this->sign ? big_integer(0) : big_integer(-1);
     }
 
-    for (size_t i = blocks; i < data.size(); i++)
+    // Floor semantics: a negative value loses magnitude rounded up.
+    uint32_t *p = data.mutable_data();
+    bool lost = false;
+    for (size_t i = 0; i < blocks && !lost; ++i)
     {
-        data[i - blocks] = data[i];
+        lost = p[i] != 0;
     }
+    uint32_t out = limbs_rshift(p, p + blocks, n - blocks, bits);
+    lost = lost || out != 0;
+    data.resize(n - blocks);
+    delete_zeroes();
 
-    uint32_t mask = (this->sign ? 0 : (std::numeric_limits<uint32_t>::max() - 1));
-    for (size_t i = 0; i < blocks; i++)
+    if (!this->sign && lost)
     {
-        data[data.size() - i - 1] = mask;
+        this->abs_add(B_ONE);
     }
-
-    this->convert();
-    delete_zeroes();
-
+    if (is_zero()) this->sign = true;
     return *this;
 }
 
@@ -475,7 +425,7 @@ big_integer big_integer::operator+() const
 big_integer big_integer::operator-() const
 {
     big_integer r(*this);
-    r.sign = !r.sign;
+    r.sign = !r.sign || r.is_zero();
     return r;
 }
 
@@ -483,7 +433,7 @@ big_integer big_integer::operator~() const
 {
     big_integer r(*this);
     ++r;
-    r.sign = !r.sign;
+    r.sign = !r.sign || r.is_zero();
     return r;
 }
 
@@ -514,78 +464,226 @@ big_integer big_integer::operator--(int)
 }
 
 std::string to_string(big_integer const &a) {
-    if (a.is_zero())
-    {
-        return "0";
-    }
-
-    big_integer x(a);
-    std::string res = "";
+    return to_string(a, 10);
+}
 
-    while (!x.is_zero())
-    {
-        int8_t digit = (int8_t)x.div_and_mod_by_short(10);
-        res.push_back((int8_t)(digit) + (int8_t) '0');
-    }
+std::string to_string(big_integer const &a, int base)
+{
+    if (base < 2 || base > 36) throw std::invalid_argument("to_string: base must be in [2, 36]");
+    expr_term t = big_integer_expr_access::term(a);
+    std::string res;
+    if (t.neg) res.push_back('-');
+    string_output out(res);
+    limbs_to_radix(t.limbs, t.size, static_cast<unsigned>(base), false, out);
+    return res;
+}
 
-    while (res[res.size() - 1] == '0')
-    {
-        res.pop_back();
-    }
-    if (!x.sign) res.push_back('-');
+bool from_string(char const *s, size_t len, int base, big_integer &out)
+{
+    if (base < 2 || base > 36) return false;
+    size_t begin = len > 0 && (s[0] == '-' || s[0] == '+') ? 1 : 0;
+    std::vector<uint32_t> limbs;
+    if (begin == len || !limbs_from_radix(s + begin, len - begin, static_cast<unsigned>(base), limbs)) return false;
+    big_integer_expr_access::assign(out, limbs.data(), limbs.size(), s[0] == '-');
+    return true;
+}
 
-    std::reverse(res.begin(), res.end());
-    return res;
+bool from_string(std::string const &s, int base, big_integer &out)
+{
+    return from_string(s.data(), s.size(), base, out);
 }
 
 big_integer operator+(big_integer a, big_integer const &b)
 {
-    return a += b;
+    return std::move(a += b);
+}
+
+big_integer operator+(big_integer const &a, big_integer &&b)
+{
+    return std::move(b += a);
 }
 
 big_integer operator-(big_integer a, big_integer const &b)
 {
-    return a -= b;
+    return std::move(a -= b);
 }
 
 big_integer operator*(big_integer a, big_integer const &b)
 {
-    return a *= b;
+    return std::move(a *= b);
+}
+
+big_integer operator*(big_integer const &a, big_integer &&b)
+{
+    return std::move(b *= a);
 }
 
 big_integer operator/(big_integer a, big_integer const &b)
 {
-    return a /= b;
+    return std::move(a /= b);
 }
 
 big_integer operator%(big_integer a, big_integer const &b)
 {
-    return a %= b;
+    return std::move(a %= b);
 }
 
 big_integer operator&(big_integer a, big_integer const &b)
 {
-    return a &= b;
+    return std::move(a &= b);
+}
+
+big_integer operator&(big_integer const &a, big_integer &&b)
+{
+    return std::move(b &= a);
 }
 
 big_integer operator|(big_integer a, big_integer const &b)
 {
-    return a |= b;
+    return std::move(a |= b);
+}
+
+big_integer operator|(big_integer const &a, big_integer &&b)
+{
+    return std::move(b |= a);
 }
 
 big_integer operator^(big_integer a, big_integer const &b)
 {
-    return a ^= b;
+    return std::move(a ^= b);
+}
+
+big_integer operator^(big_integer const &a, big_integer &&b)
+{
+    return std::move(b ^= a);
 }
 
 big_integer operator<<(big_integer a, int b)
 {
-    return a <<= b;
+    return std::move(a <<= b);
 }
 
 big_integer operator>>(big_integer a, int b)
 {
-    return a >>= b;
+    return std::move(a >>= b);
+}
+
+divmod_result divmod(big_integer const &a, big_integer const &b)
+{
+    divmod_result res;
+    res.quotient = a;
+    res.quotient.div_rem(b, res.remainder);
+    return res;
+}
+
+void div_rem(big_integer const &a, big_integer const &b, big_integer &quot, big_integer &rem)
+{
+    big_integer q(a);
+    q.div_rem(b, rem);
+    quot = q;
+}
+
+// |a| and |b| padded to a common length n, then room for the gcd.
+static size_t gcd_operands(expr_term const &a, expr_term const &b, std::vector<uint32_t> &buf)
+{
+    size_t n = std::max(a.size, b.size);
+    buf.assign(3 * n, 0);
+    std::copy(a.limbs, a.limbs + a.size, buf.begin());
+    std::copy(b.limbs, b.limbs + b.size, buf.begin() + n);
+    return n;
+}
+
+big_integer gcd(big_integer const &a, big_integer const &b)
+{
+    std::vector<uint32_t> buf;
+    size_t n = gcd_operands(big_integer_expr_access::term(a), big_integer_expr_access::term(b), buf);
+    big_integer res;
+    if (n == 0) return res;
+    size_t gn = gcd_limbs(&buf[2 * n], &buf[0], &buf[n], n);
+    big_integer_expr_access::assign(res, &buf[2 * n], gn, false);
+    return res;
+}
+
+// g = gcd(a, b) for nonzero b; returns the cofactor x of a.
+static big_integer gcd_cofactor(big_integer const &a, big_integer const &b, big_integer &g)
+{
+    expr_term at = big_integer_expr_access::term(a);
+    std::vector<uint32_t> buf, x;
+    bool x_neg;
+    size_t n = gcd_operands(at, big_integer_expr_access::term(b), buf);
+    size_t gn = gcdext_limbs(&buf[2 * n], x, x_neg, &buf[0], &buf[n], n);
+    big_integer_expr_access::assign(g, &buf[2 * n], gn, false);
+    big_integer res;
+    big_integer_expr_access::assign(res, x.data(), x.size(), x_neg != at.neg);
+    return res;
+}
+
+extended_gcd_result extended_gcd(big_integer const &a, big_integer const &b)
+{
+    extended_gcd_result res;
+    if (b.is_zero())
+    {
+        res.gcd = a < B_ZERO ? -a : a;
+        res.x = a < B_ZERO ? -1 : (a.is_zero() ? 0 : 1);
+        return res;
+    }
+    res.x = gcd_cofactor(a, b, res.gcd);
+    res.y = (res.gcd - res.x * a) / b;
+    return res;
+}
+
+bool mod_inverse(big_integer const &a, big_integer const &m, big_integer &inv)
+{
+    big_integer mod = m < B_ZERO ? -m : m;
+    big_integer r = a % mod;
+    if (r < B_ZERO) r += mod;
+    big_integer g;
+    big_integer x = gcd_cofactor(r, mod, g);
+    if (g != B_ONE) return false;
+    if (x < B_ZERO) x += mod;
+    inv = x;
+    return true;
+}
+
+big_integer sqr(big_integer a)
+{
+    a.square_inplace();
+    return a;
+}
+
+big_integer pow(big_integer const &a, uint32_t e)
+{
+    expr_term at = big_integer_expr_access::term(a);
+    big_integer res;
+    if (at.size == 0)
+    {
+        return e == 0 ? B_ONE : res;
+    }
+    std::vector<uint32_t> buf(pow_limbs_bound(at.limbs, at.size, e));
+    buf.resize(pow_limbs(buf.data(), at.limbs, at.size, e));
+    big_integer_expr_access::assign(res, buf.data(), buf.size(), at.neg && (e & 1) != 0);
+    return res;
+}
+
+big_integer isqrt(big_integer const &a)
+{
+    return iroot(a, 2);
+}
+
+big_integer iroot(big_integer const &a, uint32_t k)
+{
+    expr_term at = big_integer_expr_access::term(a);
+    std::vector<uint32_t> buf(at.size / k + 1);
+    buf.resize(root_limbs(buf.data(), at.limbs, at.size, k));
+    big_integer res;
+    big_integer_expr_access::assign(res, buf.data(), buf.size(), at.neg);
+    return res;
+}
+
+bool is_perfect_power(big_integer const &a)
+{
+    expr_term at = big_integer_expr_access::term(a);
+    return perfect_power_limbs(at.limbs, at.size, at.neg);
 }
 
 bool operator==(big_integer const &a, big_integer const &b)
@@ -619,9 +717,130 @@ bool operator>=(big_integer const &a, big_integer const &b)
     return a.compare_to(b) >= 0;
 }
 
+namespace
+{
+// Hands digits straight to a stream buffer; ok drops on a short write.
+struct streambuf_output : radix_output
+{
+    std::streambuf *buf;
+    bool ok;
+
+    explicit streambuf_output(std::streambuf *buf) : buf(buf), ok(true) {}
+
+    void write(char const *s, size_t n)
+    {
+        std::streamsize len = static_cast<std::streamsize>(n);
+        if (this->ok && this->buf->sputn(s, len) != len) this->ok = false;
+    }
+};
+}
+
 std::ostream &operator<<(std::ostream &s, big_integer const &a)
 {
-    return s << to_string(a);
+    std::ostream::sentry guard(s);
+    if (!guard) return s;
+
+    std::ios_base::fmtflags flags = s.flags();
+    std::ios_base::fmtflags basefield = flags & std::ios_base::basefield;
+    unsigned base = basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+    bool upper = (flags & std::ios_base::uppercase) != 0;
+    expr_term t = big_integer_expr_access::term(a);
+
+    // Sign and base prefix as for built-in integers: no prefix on zero.
+    std::string prefix;
+    if (t.neg) prefix.push_back('-');
+    else if ((flags & std::ios_base::showpos) != 0) prefix.push_back('+');
+    if ((flags & std::ios_base::showbase) != 0 && t.size != 0 && base != 10)
+    {
+        prefix.push_back('0');
+        if (base == 16) prefix.push_back(upper ? 'X' : 'x');
+    }
+
+    streambuf_output out(s.rdbuf());
+    std::streamsize width = s.width(0);
+    if (width <= static_cast<std::streamsize>(prefix.size()) + 1)
+    {
+        // Nothing to pad: the digits go out in pieces as they are made.
+        out.write(prefix.data(), prefix.size());
+        limbs_to_radix(t.limbs, t.size, base, upper, out);
+    }
+    else
+    {
+        std::string digits;
+        string_output to_digits(digits);
+        limbs_to_radix(t.limbs, t.size, base, upper, to_digits);
+        size_t len = prefix.size() + digits.size();
+        std::string fill(len < static_cast<size_t>(width) ? static_cast<size_t>(width) - len : 0, s.fill());
+        std::ios_base::fmtflags adjust = flags & std::ios_base::adjustfield;
+        if (adjust != std::ios_base::left && adjust != std::ios_base::internal) out.write(fill.data(), fill.size());
+        out.write(prefix.data(), prefix.size());
+        if (adjust == std::ios_base::internal) out.write(fill.data(), fill.size());
+        out.write(digits.data(), digits.size());
+        if (adjust == std::ios_base::left) out.write(fill.data(), fill.size());
+    }
+    if (!out.ok) s.setstate(std::ios_base::badbit);
+    return s;
+}
+
+std::istream &operator>>(std::istream &s, big_integer &a)
+{
+    std::istream::sentry guard(s);
+    if (!guard) return s;
+
+    typedef std::char_traits<char> traits;
+    std::streambuf *buf = s.rdbuf();
+    std::ios_base::fmtflags basefield = s.flags() & std::ios_base::basefield;
+    unsigned base = basefield == std::ios_base::hex ? 16
+                    : basefield == std::ios_base::oct ? 8
+                    : basefield == std::ios_base::dec ? 10 : 0;
+
+    int c = buf->sgetc();
+    bool neg = c == '-';
+    if (c == '-' || c == '+') c = buf->snextc();
+
+    // A leading 0 is a digit itself, or with no basefield set it picks
+    // octal, or with x after it hexadecimal.
+    bool zero = false;
+    if ((base == 0 || base == 16) && c == '0')
+    {
+        zero = true;
+        c = buf->snextc();
+        if (c == 'x' || c == 'X')
+        {
+            zero = false;
+            base = 16;
+            c = buf->snextc();
+        }
+        else if (base == 0)
+        {
+            base = 8;
+        }
+    }
+    if (base == 0) base = 10;
+
+    // Digits are consumed one at a time and packed as they arrive.
+    radix_reader reader(base);
+    for (; !traits::eq_int_type(c, traits::eof()); c = buf->snextc())
+    {
+        unsigned d = radix_digit_value(traits::to_char_type(c));
+        if (d >= base) break;
+        reader.push(d);
+    }
+
+    std::ios_base::iostate state = std::ios_base::goodbit;
+    if (traits::eq_int_type(c, traits::eof())) state |= std::ios_base::eofbit;
+    if (reader.digits() == 0 && !zero)
+    {
+        a = B_ZERO;
+        state |= std::ios_base::failbit;
+    }
+    else
+    {
+        std::vector<uint32_t> limbs = reader.finish();
+        big_integer_expr_access::assign(a, limbs.data(), limbs.size(), neg);
+    }
+    s.setstate(state);
+    return s;
 }
 
 int8_t big_integer::compare_to(big_integer const &other) const
@@ -654,14 +873,7 @@ int8_t big_integer::compare_to(big_integer const &other) const
 
 int8_t big_integer::compare_by_abs(big_integer const &other) const
 {
-    if (this->data.size() > other.data.size()) return 1;
-    if (this->data.size() < other.data.size()) return -1;
-    for (size_t i = this->data.size(); i > 0; --i)
-    {
-        if (this->data[i - 1] > other.data[i - 1]) return 1;
-        if (this->data[i - 1] < other.data[i - 1]) return -1;
-    }
-    return 0;
+    return static_cast<int8_t>(limbs_cmp(this->data.data(), this->data.size(), other.data.data(), other.data.size()));
 }
 
 bool big_integer::is_zero() const
@@ -669,82 +881,32 @@ bool big_integer::is_zero() const
     return (this->data.size() == 1 && this->data[0] == 0);
 }
 
-big_integer &big_integer::convert()
-{
-    if (!this->sign)
-    {
-        this->abs_sub(B_ONE, false);
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            data[i] = ~data[i];
-        }
-    }
-    return *this;
-}
-
 big_integer &big_integer::add_long_short(uint32_t x)
 {
-    uint64_t tmp, carry = 0;
-    tmp = static_cast<uint64_t>(this->data[0]) + static_cast<uint64_t>(x);
-    carry = tmp / BASE;
-    this->data[0] = static_cast<uint32_t> (tmp % BASE);
-
-    size_t k = 1;
-
-    while (carry != 0)
-    {
-        if (k == this->data.size()) data.push_back(0);
-        tmp = static_cast<uint64_t>(data[k]) + carry;
-        carry = tmp / BASE;
-        data[k] = static_cast<uint32_t> (tmp % BASE);
-        ++k;
-    }
+    uint32_t *p = data.mutable_data();
+    uint32_t carry = limbs_add_1(p, p, data.size(), x);
+    if (carry != 0) data.push_back(carry);
     return *this;
 }
 
 big_integer &big_integer::mul_long_short(uint32_t x)
 {
-    uint64_t res, carry = 0;
-    for (size_t i = 0; i < data.size(); i++)
-    {
-        res = static_cast<uint64_t>(this->data[i]) * static_cast<uint64_t>(x) + carry;
-        carry = res / BASE;
-        this->data[i] = static_cast<uint32_t> (res % BASE);
-
-    }
-
-    size_t k = data.size();
-
-    while (carry != 0)
-    {
-        if (k == this->data.size()) data.push_back(0);
-        res = static_cast<uint64_t>(data[k]) + carry;
-        carry = res / BASE;
-        data[k] = static_cast<uint32_t>(res % BASE);
-        k++;
-    }
+    uint32_t *p = data.mutable_data();
+    uint32_t carry = limbs_mul_1(p, p, data.size(), x);
+    if (carry != 0) data.push_back(carry);
     return *this;
 }
 
 uint32_t big_integer::div_and_mod_by_short(uint32_t x)
 {
-    uint64_t carry = 0;
-    for (size_t i = this->data.size(); i > 0; --i)
-    {
-        uint64_t temp = static_cast<int64_t>(this->data[i - 1]) + carry * BASE;
-        this->data[i - 1] = static_cast<uint32_t> (temp / static_cast<uint64_t>(x));
-        carry = temp % static_cast<uint64_t>(x);
-    }
-
+    uint32_t *p = data.mutable_data();
+    uint32_t rem = limbs_divrem_1(p, p, data.size(), x);
     delete_zeroes();
-    return static_cast<uint32_t> (carry);
+    return rem;
 }
 
 void big_integer::delete_zeroes()
 {
-    while (this->data.size() > 1 && this->data.back() == 0)
-    {
-        this->data.pop_back();
-    }
+    size_t n = limbs_normalized_size(data.data(), data.size());
+    data.resize(n == 0 ? 1 : n);
 }
-
@@ -10,12 +10,14 @@ struct big_integer
 {
     big_integer();
     big_integer(big_integer const& other);
+    big_integer(big_integer&& other) noexcept;
     big_integer(int a);
     big_integer(uint32_t x);
     explicit big_integer(std::string const& str);
     ~big_integer();
 
     big_integer& operator=(big_integer const& other);
+    big_integer& operator=(big_integer&& other) noexcept;
 
     big_integer& operator+=(big_integer const& rhs);
     big_integer& operator-=(big_integer const& rhs);
@@ -23,6 +25,12 @@ struct big_integer
     big_integer& operator/=(big_integer const& rhs);
     big_integer& operator%=(big_integer const& rhs);
 
+    // *this becomes the quotient truncated towards zero, rem the remainder
+    // with the sign of the dividend. rem must not be *this.
+    big_integer& div_rem(big_integer const& rhs, big_integer& rem);
+    // *this = *this * *this through the squaring kernels; x *= x lands here.
+    big_integer& square_inplace();
+
     big_integer& operator&=(big_integer const& rhs);
     big_integer& operator|=(big_integer const& rhs);
     big_integer& operator^=(big_integer const& rhs);
@@ -50,30 +58,73 @@ struct big_integer
     bool is_zero() const;
 
 private:
+    friend struct big_integer_expr_access;
+
     bool sign;
     vector_with_opt data;
-    const static uint64_t BASE = static_cast<uint32_t>(std::numeric_limits<uint32_t>::max());
 
     int8_t compare_by_abs(big_integer const &other) const;
     int8_t compare_to(big_integer const& other) const;
-    big_integer& abs_sub(big_integer rhs, bool swap);
+    big_integer& abs_sub(big_integer const& rhs, bool swap);
     big_integer& abs_add(big_integer const& other);
     uint32_t div_and_mod_by_short(uint32_t x);
     big_integer& mul_long_short(uint32_t x);
     big_integer& add_long_short(uint32_t x);
-    big_integer& convert();
+    template <class Op>
+    big_integer& bitwise(big_integer const& rhs);
     void delete_zeroes();
 };
 
 big_integer operator+(big_integer a, big_integer const& b);
+big_integer operator+(big_integer const& a, big_integer&& b);
 big_integer operator-(big_integer a, big_integer const& b);
 big_integer operator*(big_integer a, big_integer const& b);
+big_integer operator*(big_integer const& a, big_integer&& b);
 big_integer operator/(big_integer a, big_integer const& b);
 big_integer operator%(big_integer a, big_integer const& b);
 
+struct divmod_result
+{
+    big_integer quotient;
+    big_integer remainder;
+};
+
+// One division producing both a / b and a % b.
+divmod_result divmod(big_integer const& a, big_integer const& b);
+void div_rem(big_integer const& a, big_integer const& b, big_integer& quot, big_integer& rem);
+
+struct extended_gcd_result
+{
+    big_integer gcd;
+    big_integer x;
+    big_integer y;
+};
+
+// The greatest common divisor, never negative; gcd(0, 0) = 0.
+big_integer gcd(big_integer const& a, big_integer const& b);
+// gcd(a, b) with Bezout coefficients: gcd = x * a + y * b.
+extended_gcd_result extended_gcd(big_integer const& a, big_integer const& b);
+// inv = a^-1 mod m, in [0, |m|), when gcd(a, m) = 1. Otherwise returns
+// false and leaves inv alone. m must be nonzero.
+bool mod_inverse(big_integer const& a, big_integer const& m, big_integer& inv);
+
+// a * a.
+big_integer sqr(big_integer a);
+// a^e; pow(0, 0) = 1.
+big_integer pow(big_integer const& a, uint32_t e);
+// floor(sqrt(a)) for a >= 0.
+big_integer isqrt(big_integer const& a);
+// The k-th root of a rounded toward zero, for k >= 1 and a >= 0 or odd k.
+big_integer iroot(big_integer const& a, uint32_t k);
+// Whether a = b^k for some b and some k >= 2; 0, 1 and -1 are.
+bool is_perfect_power(big_integer const& a);
+
 big_integer operator&(big_integer a, big_integer const& b);
+big_integer operator&(big_integer const& a, big_integer&& b);
 big_integer operator|(big_integer a, big_integer const& b);
+big_integer operator|(big_integer const& a, big_integer&& b);
 big_integer operator^(big_integer a, big_integer const& b);
+big_integer operator^(big_integer const& a, big_integer&& b);
 
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
@@ -86,6 +137,19 @@ bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
 std::string to_string(big_integer const& a);
+// Digits of a in base (2 to 36), lowercase, after a '-' when negative.
+// Throws std::invalid_argument for any other base.
+std::string to_string(big_integer const& a, int base);
+// Parses an optional sign and then digits of base (2 to 36), all of s[0, len).
+// False, leaving out alone, when that is not what s holds.
+bool from_string(char const* s, size_t len, int base, big_integer& out);
+bool from_string(std::string const& s, int base, big_integer& out);
+
+// Honor std::hex, std::oct, showbase, showpos, uppercase and the field width.
+// Digits go to the stream buffer in pieces, and are read off it one at a
+// time, so neither direction holds the whole text. With no basefield set,
+// input takes a 0x or 0 prefix as hexadecimal or octal, like strtol.
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
+std::istream& operator>>(std::istream& s, big_integer& a);
 
 #endif // BIG_INTEGER_H
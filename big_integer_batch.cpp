@@ -0,0 +1,378 @@
+#include "big_integer_batch.h"
+#include "big_integer_expr.h"
+#include "div_engine.h"
+#include "limb_ops.h"
+#include "limb_simd.h"
+#include "mul_engine.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+// Elements order[first, first + count) handled together: a single element,
+// or, when lanes is set, up to limb_simd->lanes products of equal operand
+// lengths computed side by side.
+struct batch_job
+{
+    size_t first;
+    size_t count;
+    size_t cost;
+    bool lanes;
+};
+
+// Operands of one element, its slice of the scratch buffer and the
+// normalized length and sign of its result there.
+struct batch_item
+{
+    expr_term x;
+    expr_term y;
+    size_t offset;
+    size_t size;
+    bool neg;
+};
+
+struct batch_workspace
+{
+    std::vector<batch_item> items;
+    std::vector<size_t> order;
+    std::vector<batch_job> jobs;
+    std::vector<uint32_t> scratch;
+    bool busy;
+
+    batch_workspace() : busy(false) {}
+};
+
+// Buffers kept per thread between batches, so that a steady stream of them
+// neither allocates nor faults in fresh pages. A batch started while the
+// thread's buffers are taken (from a task it runs while waiting) gets
+// fresh ones.
+class workspace_lease
+{
+public:
+    workspace_lease() : ws(&cached())
+    {
+        if (ws->busy) ws = &fresh;
+        ws->busy = true;
+    }
+
+    ~workspace_lease()
+    {
+        ws->busy = false;
+    }
+
+    batch_workspace &get()
+    {
+        return *ws;
+    }
+
+private:
+    static batch_workspace &cached()
+    {
+        thread_local batch_workspace workspace;
+        return workspace;
+    }
+
+    batch_workspace fresh;
+    batch_workspace *ws;
+};
+
+typedef std::function<void(batch_job const *, size_t)> job_runner;
+}
+
+// Longest operand multiplied in SIMD lanes.
+static const size_t LANE_MAX_LIMBS = 32;
+
+// Splits jobs into contiguous ranges of similar total cost, a few per
+// thread so that stealing can even out bad estimates, and runs them.
+static void run_jobs(thread_pool *pool, std::vector<batch_job> const &jobs, job_runner const &run)
+{
+    if (pool == 0)
+    {
+        if (!jobs.empty()) run(jobs.data(), jobs.size());
+        return;
+    }
+
+    size_t parts = 4 * (pool->workers() + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) total += jobs[i].cost;
+
+    std::vector<std::function<void()> > tasks;
+    size_t begin = 0;
+    size_t done = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        done += jobs[i].cost;
+        if (done * parts >= total * (tasks.size() + 1) || i + 1 == jobs.size())
+        {
+            tasks.push_back([&run, &jobs, begin, i] { run(&jobs[begin], i + 1 - begin); });
+            begin = i + 1;
+        }
+    }
+    run_all(pool, tasks.data(), tasks.size());
+}
+
+// Gives each of the n items a slice of len(item) scratch limbs and a job of
+// its own costing cost(item).
+template <class Len, class Cost>
+static void plan_elements(batch_workspace &ws, size_t n, Len const &len, Cost const &cost)
+{
+    ws.jobs.resize(n);
+    size_t offset = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        ws.items[i].offset = offset;
+        offset += len(ws.items[i]);
+        batch_job job = {i, 1, cost(ws.items[i]), false};
+        ws.jobs[i] = job;
+    }
+    ws.scratch.resize(offset);
+}
+
+// Outputs are assigned on the calling thread once every task is done: their
+// old values may share limbs with each other or with the inputs, and
+// without BIGINT_THREAD_SAFE those link counts must not be released
+// concurrently.
+static void assign_results(batch_span<big_integer> out, batch_workspace const &ws)
+{
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        batch_item const &item = ws.items[i];
+        big_integer_expr_access::assign(out[i], ws.scratch.data() + item.offset, item.size, item.neg);
+    }
+}
+
+// r = x + y, r has max(x.size, y.size) + 1 limbs. Returns the normalized
+// length and sets neg to the sign of the sum.
+static size_t signed_add(uint32_t *r, expr_term x, expr_term y, bool &neg)
+{
+    if (x.neg == y.neg)
+    {
+        if (x.size < y.size) std::swap(x, y);
+        r[x.size] = limbs_add(r, x.limbs, x.size, y.limbs, y.size);
+        neg = x.neg;
+        return limbs_normalized_size(r, x.size + 1);
+    }
+    if (limbs_cmp(x.limbs, x.size, y.limbs, y.size) < 0) std::swap(x, y);
+    limbs_sub(r, x.limbs, x.size, y.limbs, y.size);
+    neg = x.neg;
+    return limbs_normalized_size(r, x.size);
+}
+
+static void add_or_sub(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                       batch_span<big_integer> out, thread_pool *pool, bool negate_b)
+{
+    workspace_lease lease;
+    batch_workspace &ws = lease.get();
+    size_t n = out.size();
+    ws.items.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ws.items[i].x = big_integer_expr_access::term(a[i]);
+        ws.items[i].y = big_integer_expr_access::term(b[i]);
+        ws.items[i].y.neg = ws.items[i].y.neg != negate_b;
+    }
+    auto len = [](batch_item const &item)
+    {
+        return std::max(item.x.size, item.y.size) + 1;
+    };
+    plan_elements(ws, n, len, len);
+
+    run_jobs(pool, ws.jobs, [&](batch_job const *job, size_t count)
+    {
+        for (size_t k = 0; k < count; ++k)
+        {
+            batch_item &item = ws.items[job[k].first];
+            item.size = signed_add(ws.scratch.data() + item.offset, item.x, item.y, item.neg);
+        }
+    });
+    assign_results(out, ws);
+}
+
+void big_integer_batch::add(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                            batch_span<big_integer> out, thread_pool *pool)
+{
+    add_or_sub(a, b, out, pool, false);
+}
+
+void big_integer_batch::sub(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                            batch_span<big_integer> out, thread_pool *pool)
+{
+    add_or_sub(a, b, out, pool, true);
+}
+
+void big_integer_batch::mul(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                            batch_span<big_integer> out, thread_pool *pool)
+{
+    workspace_lease lease;
+    batch_workspace &ws = lease.get();
+    size_t n = out.size();
+    limb_simd_kernels const *simd = limb_simd;
+    // Lanes only pay off where mul_limbs would use schoolbook anyway.
+    size_t lane_limit = simd == 0 ? 0 : std::min(mul_tuning().karatsuba, LANE_MAX_LIMBS);
+
+    // x is the longer operand. Lane candidates are bucketed by their operand
+    // lengths, everything else goes to bucket 0; the bucket is parked in
+    // size until the results are in.
+    ws.items.resize(n);
+    std::vector<size_t> start(lane_limit * lane_limit + 2, 0);
+    size_t offset = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        batch_item &item = ws.items[i];
+        item.x = big_integer_expr_access::term(a[i]);
+        item.y = big_integer_expr_access::term(b[i]);
+        if (item.x.size < item.y.size) std::swap(item.x, item.y);
+        item.neg = item.x.neg != item.y.neg;
+        item.offset = offset;
+        offset += item.x.size + item.y.size;
+        bool in_lanes = item.y.size != 0 && item.x.size < lane_limit;
+        item.size = in_lanes ? item.x.size * lane_limit + item.y.size : 0;
+        ++start[item.size + 1];
+    }
+    ws.scratch.resize(offset);
+
+    // Counting sort into order, grouping equal lengths.
+    for (size_t k = 1; k < start.size(); ++k) start[k] += start[k - 1];
+    ws.order.resize(n);
+    for (size_t i = 0; i < n; ++i) ws.order[start[ws.items[i].size]++] = i;
+
+    ws.jobs.clear();
+    for (size_t pos = 0; pos < n;)
+    {
+        batch_item const &item = ws.items[ws.order[pos]];
+        size_t cost = std::max<size_t>(item.x.size * item.y.size, 1);
+        if (item.size == 0)
+        {
+            batch_job job = {pos++, 1, cost, false};
+            ws.jobs.push_back(job);
+            continue;
+        }
+
+        size_t end = pos + 1;
+        while (end < n && ws.items[ws.order[end]].size == item.size) ++end;
+        while (pos < end)
+        {
+            // A group filling under half the lanes is cheaper one by one.
+            size_t count = std::min(simd->lanes, end - pos);
+            bool lanes = count >= 2 && 2 * count >= simd->lanes;
+            if (!lanes) count = 1;
+            batch_job job = {pos, count, cost, lanes};
+            ws.jobs.push_back(job);
+            pos += count;
+        }
+    }
+
+    run_jobs(pool, ws.jobs, [&](batch_job const *job, size_t count)
+    {
+        std::vector<uint64_t> la, lb, lr;
+        for (size_t k = 0; k < count; ++k)
+        {
+            size_t const *group = &ws.order[job[k].first];
+            if (!job[k].lanes)
+            {
+                batch_item &item = ws.items[group[0]];
+                uint32_t *r = ws.scratch.data() + item.offset;
+                item.size = 0;
+                if (item.y.size != 0)
+                {
+                    mul_limbs(r, item.x.limbs, item.x.size, item.y.limbs, item.y.size);
+                    item.size = limbs_normalized_size(r, item.x.size + item.y.size);
+                }
+                continue;
+            }
+
+            // Transpose the operands so limb d of lane l sits at d * lanes + l;
+            // unused lanes stay zero.
+            size_t lanes = simd->lanes;
+            size_t an = ws.items[group[0]].x.size;
+            size_t bn = ws.items[group[0]].y.size;
+            la.assign(an * lanes, 0);
+            lb.assign(bn * lanes, 0);
+            lr.resize((an + bn) * lanes);
+            for (size_t l = 0; l < job[k].count; ++l)
+            {
+                batch_item const &item = ws.items[group[l]];
+                for (size_t d = 0; d < an; ++d) la[d * lanes + l] = item.x.limbs[d];
+                for (size_t d = 0; d < bn; ++d) lb[d * lanes + l] = item.y.limbs[d];
+            }
+            simd->mul_lanes(lr.data(), la.data(), an, lb.data(), bn);
+            for (size_t l = 0; l < job[k].count; ++l)
+            {
+                batch_item &item = ws.items[group[l]];
+                uint32_t *r = ws.scratch.data() + item.offset;
+                for (size_t d = 0; d < an + bn; ++d) r[d] = static_cast<uint32_t>(lr[d * lanes + l]);
+                item.size = limbs_normalized_size(r, an + bn);
+            }
+        }
+    });
+    assign_results(out, ws);
+}
+
+void big_integer_batch::mod(batch_span<big_integer const> x, big_integer const &m,
+                            batch_span<big_integer> out, thread_pool *pool)
+{
+    // The divisor is copied, and below the Burnikel-Ziegler threshold
+    // normalized, once for the whole batch.
+    expr_term mt = big_integer_expr_access::term(m);
+    size_t vn = mt.size;
+    std::vector<uint32_t> v(mt.limbs, mt.limbs + vn), nv(v);
+    unsigned shift = vn > 1 ? static_cast<unsigned>(__builtin_clz(v[vn - 1])) : 0;
+    bool basecase = vn > 1 && vn < BZ_THRESHOLD;
+    if (basecase) limbs_lshift(&nv[0], &v[0], vn, shift);
+
+    workspace_lease lease;
+    batch_workspace &ws = lease.get();
+    size_t n = out.size();
+    ws.items.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ws.items[i].x = big_integer_expr_access::term(x[i]);
+        ws.items[i].neg = ws.items[i].x.neg;
+    }
+    plan_elements(ws, n, [vn](batch_item const &)
+    {
+        return vn;
+    }, [vn](batch_item const &item)
+    {
+        return std::max<size_t>(item.x.size * vn, 1);
+    });
+
+    run_jobs(pool, ws.jobs, [&](batch_job const *job, size_t count)
+    {
+        std::vector<uint32_t> q, u;
+        for (size_t k = 0; k < count; ++k)
+        {
+            batch_item &item = ws.items[job[k].first];
+            expr_term const &t = item.x;
+            uint32_t *r = ws.scratch.data() + item.offset;
+            if (limbs_cmp(t.limbs, t.size, &v[0], vn) < 0)
+            {
+                std::copy(t.limbs, t.limbs + t.size, r);
+                item.size = t.size;
+            }
+            else if (vn == 1)
+            {
+                q.resize(t.size);
+                r[0] = limbs_divrem_1(&q[0], t.limbs, t.size, v[0]);
+                item.size = r[0] != 0;
+            }
+            else if (basecase)
+            {
+                u.resize(t.size + 1);
+                q.resize(t.size + 1 - vn);
+                u[t.size] = limbs_lshift(&u[0], t.limbs, t.size, shift);
+                div_basecase(&q[0], &u[0], t.size + 1, &nv[0], vn);
+                limbs_rshift(r, &u[0], vn, shift);
+                item.size = limbs_normalized_size(r, vn);
+            }
+            else
+            {
+                q.resize(t.size - vn + 1);
+                div_limbs(&q[0], r, t.limbs, t.size, &v[0], vn);
+                item.size = limbs_normalized_size(r, vn);
+            }
+        }
+    });
+    assign_results(out, ws);
+}
@@ -0,0 +1,61 @@
+#ifndef BIG_INTEGER_BATCH_H
+#define BIG_INTEGER_BATCH_H
+
+#include <stddef.h>
+#include <vector>
+#include "big_integer.h"
+
+class thread_pool;
+
+// Non-owning view of count consecutive values.
+template <class T>
+struct batch_span
+{
+    T *ptr;
+    size_t count;
+
+    batch_span(T *p, size_t n) : ptr(p), count(n) {}
+
+    template <class V>
+    batch_span(std::vector<V> &v) : ptr(v.data()), count(v.size()) {}
+
+    template <class V>
+    batch_span(std::vector<V> const &v) : ptr(v.data()), count(v.size()) {}
+
+    T &operator[](size_t i) const
+    {
+        return ptr[i];
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+};
+
+// The same operation over many independent operands, out[i] = a[i] op b[i].
+// Raw results are written to one scratch buffer sized up front, kept per
+// thread between calls, and each output is then assigned once at its final
+// length. With a pool the
+// elements are split across its threads by estimated cost. Products of
+// short operands with equal lengths are computed side by side, one pair
+// per SIMD lane.
+//
+// The inputs have out.size() values. Outputs are only written after every
+// result is computed, so out may overlap the inputs.
+struct big_integer_batch
+{
+    static void add(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                    batch_span<big_integer> out, thread_pool *pool = 0);
+    static void sub(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                    batch_span<big_integer> out, thread_pool *pool = 0);
+    static void mul(batch_span<big_integer const> a, batch_span<big_integer const> b,
+                    batch_span<big_integer> out, thread_pool *pool = 0);
+
+    // out[i] = x[i] % m with the sign of x[i], as operator%. m must be
+    // nonzero.
+    static void mod(batch_span<big_integer const> x, big_integer const &m,
+                    batch_span<big_integer> out, thread_pool *pool = 0);
+};
+
+#endif // BIG_INTEGER_BATCH_H
@@ -0,0 +1,217 @@
+#include "big_integer_binary.h"
+#include "limb_ops.h"
+#include <cstring>
+
+static const bool LITTLE_ENDIAN_HOST = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// Longest LEB128 encoding of a 64-bit header.
+static const size_t MAX_VARINT_BYTES = 10;
+
+big_integer_view::big_integer_view(uint32_t const *limbs, size_t n, bool neg) : limbs(limbs)
+{
+    this->size = limbs_normalized_size(limbs, n);
+    this->neg = neg && this->size != 0;
+}
+
+big_integer_view::big_integer_view(big_integer const &a)
+{
+    expr_term t = big_integer_expr_access::term(a);
+    this->limbs = t.limbs;
+    this->size = t.size;
+    this->neg = t.neg;
+}
+
+big_integer big_integer_view::to_big_integer() const
+{
+    big_integer res;
+    big_integer_expr_access::assign(res, this->limbs, this->size, this->neg);
+    return res;
+}
+
+int compare(big_integer_view const &a, big_integer_view const &b)
+{
+    if (a.neg != b.neg) return a.neg ? -1 : 1;
+    int c = limbs_cmp(a.limbs, a.size, b.limbs, b.size);
+    return a.neg ? -c : c;
+}
+
+bool operator==(big_integer_view const &a, big_integer_view const &b)
+{
+    return compare(a, b) == 0;
+}
+
+bool operator!=(big_integer_view const &a, big_integer_view const &b)
+{
+    return compare(a, b) != 0;
+}
+
+bool operator<(big_integer_view const &a, big_integer_view const &b)
+{
+    return compare(a, b) < 0;
+}
+
+static uint64_t header_of(big_integer_view const &a)
+{
+    return static_cast<uint64_t>(a.size) << 1 | (a.neg ? 1 : 0);
+}
+
+static size_t header_size(uint64_t header, binary_format format)
+{
+    if (format == binary_format::fixed) return 4;
+    size_t n = 1;
+    for (; header >= 0x80; header >>= 7) ++n;
+    return n;
+}
+
+// Parses a header from in[0, size); returns its length, or 0 when it is
+// truncated or does not fit.
+static size_t read_header(uint8_t const *in, size_t size, binary_format format, uint64_t &header)
+{
+    if (format == binary_format::fixed)
+    {
+        if (size < 4) return 0;
+        header = static_cast<uint64_t>(in[0]) | static_cast<uint64_t>(in[1]) << 8 |
+                 static_cast<uint64_t>(in[2]) << 16 | static_cast<uint64_t>(in[3]) << 24;
+        return 4;
+    }
+    header = 0;
+    for (size_t i = 0; i < size && i < MAX_VARINT_BYTES; ++i)
+    {
+        uint64_t bits = in[i] & 0x7f;
+        if (i == MAX_VARINT_BYTES - 1 && bits > 1) return 0;
+        header |= bits << (7 * i);
+        if ((in[i] & 0x80) != 0) continue;
+        // An overlong encoding ends in a zero byte.
+        return i > 0 && in[i] == 0 ? 0 : i + 1;
+    }
+    return 0;
+}
+
+static uint32_t read_limb(uint8_t const *in)
+{
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 | static_cast<uint32_t>(in[2]) << 16 |
+           static_cast<uint32_t>(in[3]) << 24;
+}
+
+// Validates the encoding at in[0, size): sets n and neg and returns the
+// header length, or 0.
+static size_t parse(uint8_t const *in, size_t size, binary_format format, size_t &n, bool &neg)
+{
+    uint64_t header;
+    size_t h = read_header(in, size, format, header);
+    if (h == 0) return 0;
+    uint64_t limbs = header >> 1;
+    neg = (header & 1) != 0;
+    if (limbs > (size - h) / 4) return 0;
+    n = static_cast<size_t>(limbs);
+    if (n == 0 ? neg : read_limb(in + h + 4 * (n - 1)) == 0) return 0;
+    return h;
+}
+
+size_t serialized_size(big_integer_view const &a, binary_format format)
+{
+    return header_size(header_of(a), format) + 4 * a.size;
+}
+
+size_t serialized_size(big_integer const &a, binary_format format)
+{
+    return serialized_size(big_integer_view(a), format);
+}
+
+size_t serialize_to(big_integer_view const &a, uint8_t *out, size_t size, binary_format format)
+{
+    uint64_t header = header_of(a);
+    if (format == binary_format::fixed && header > UINT32_MAX) return 0;
+    size_t total = serialized_size(a, format);
+    if (total > size) return 0;
+
+    size_t h = header_size(header, format);
+    if (format == binary_format::fixed)
+    {
+        for (size_t i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(header >> (8 * i));
+    }
+    else
+    {
+        for (size_t i = 0; i < h; ++i)
+        {
+            out[i] = static_cast<uint8_t>((header & 0x7f) | (i + 1 < h ? 0x80 : 0));
+            header >>= 7;
+        }
+    }
+
+    uint8_t *p = out + h;
+    if (LITTLE_ENDIAN_HOST)
+    {
+        if (a.size != 0) std::memcpy(p, a.limbs, 4 * a.size);
+        return total;
+    }
+    for (size_t i = 0; i < a.size; ++i, p += 4)
+    {
+        uint32_t x = a.limbs[i];
+        p[0] = static_cast<uint8_t>(x);
+        p[1] = static_cast<uint8_t>(x >> 8);
+        p[2] = static_cast<uint8_t>(x >> 16);
+        p[3] = static_cast<uint8_t>(x >> 24);
+    }
+    return total;
+}
+
+size_t serialize_to(big_integer const &a, uint8_t *out, size_t size, binary_format format)
+{
+    return serialize_to(big_integer_view(a), out, size, format);
+}
+
+std::vector<uint8_t> serialize(big_integer const &a, binary_format format)
+{
+    big_integer_view v(a);
+    std::vector<uint8_t> res(serialized_size(v, format));
+    res.resize(serialize_to(v, res.data(), res.size(), format));
+    return res;
+}
+
+// Whether the limbs at p can be read in place as uint32_t.
+static bool aligned_limbs(uint8_t const *p)
+{
+    return LITTLE_ENDIAN_HOST && reinterpret_cast<uintptr_t>(p) % alignof(uint32_t) == 0;
+}
+
+size_t deserialize(uint8_t const *in, size_t size, big_integer &out, binary_format format)
+{
+    size_t n;
+    bool neg;
+    size_t h = parse(in, size, format, n, neg);
+    if (h == 0) return 0;
+
+    uint8_t const *p = in + h;
+    if (aligned_limbs(p))
+    {
+        // Copied straight from the buffer; short values stay inline.
+        big_integer_expr_access::assign(out, reinterpret_cast<uint32_t const *>(p), n, neg);
+        return h + 4 * n;
+    }
+    std::vector<uint32_t> limbs(n);
+    if (LITTLE_ENDIAN_HOST)
+    {
+        if (n != 0) std::memcpy(limbs.data(), p, 4 * n);
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i) limbs[i] = read_limb(p + 4 * i);
+    }
+    big_integer_expr_access::assign(out, limbs.data(), limbs.size(), neg);
+    return h + 4 * n;
+}
+
+size_t deserialize(uint8_t const *in, size_t size, big_integer_view &out, binary_format format)
+{
+    size_t n;
+    bool neg;
+    size_t h = parse(in, size, format, n, neg);
+    uint8_t const *p = in + h;
+    if (h == 0 || !aligned_limbs(p)) return 0;
+
+    out.limbs = reinterpret_cast<uint32_t const *>(p);
+    out.size = n;
+    out.neg = neg;
+    return h + 4 * n;
+}
@@ -0,0 +1,103 @@
+#ifndef BIG_INTEGER_BINARY_H
+#define BIG_INTEGER_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "big_integer.h"
+#include "big_integer_expr.h"
+
+// Binary wire format: a header holding (limb count << 1) | negative, then
+// the limbs of |a| as little-endian 32-bit words, lowest first. Zero has no
+// limbs and is never negative, and the top limb is never zero, so every
+// value has exactly one encoding.
+//
+// The header is either a little-endian 32-bit word (fixed), which keeps the
+// limbs as aligned as the header so they can be viewed in place, or an
+// LEB128 varint (varint), one byte up to 63 limbs.
+enum class binary_format
+{
+    fixed,
+    varint
+};
+
+// A read-only value over limbs owned elsewhere: a big_integer, an mmap'd
+// file, a network buffer. Nothing is copied, so the limbs must outlive the
+// view. size is normalized.
+struct big_integer_view
+{
+    uint32_t const *limbs;
+    size_t size;
+    bool neg;
+
+    big_integer_view() : limbs(0), size(0), neg(false) {}
+
+    // (neg ? -1 : 1) * limbs[0, n); leading zero limbs are dropped.
+    big_integer_view(uint32_t const *limbs, size_t n, bool neg);
+
+    // Views a's limbs; invalidated by any change to a.
+    explicit big_integer_view(big_integer const &a);
+
+    bool is_zero() const
+    {
+        return this->size == 0;
+    }
+
+    big_integer to_big_integer() const;
+};
+
+// Like limbs_cmp, with signs: negative, zero or positive as a <, =, > b.
+int compare(big_integer_view const &a, big_integer_view const &b);
+bool operator==(big_integer_view const &a, big_integer_view const &b);
+bool operator!=(big_integer_view const &a, big_integer_view const &b);
+bool operator<(big_integer_view const &a, big_integer_view const &b);
+
+size_t serialized_size(big_integer_view const &a, binary_format format = binary_format::fixed);
+size_t serialized_size(big_integer const &a, binary_format format = binary_format::fixed);
+
+// Writes a to out[0, size). Returns the bytes written, or 0 (writing
+// nothing) when they do not fit.
+size_t serialize_to(big_integer_view const &a, uint8_t *out, size_t size, binary_format format = binary_format::fixed);
+size_t serialize_to(big_integer const &a, uint8_t *out, size_t size, binary_format format = binary_format::fixed);
+std::vector<uint8_t> serialize(big_integer const &a, binary_format format = binary_format::fixed);
+
+// Reads one value from in[0, size). Returns the bytes it took, or 0 when
+// they are truncated or not a valid encoding; out is then left alone.
+size_t deserialize(uint8_t const *in, size_t size, big_integer &out, binary_format format = binary_format::fixed);
+// The same without copying: out points at the limbs inside in. Also fails
+// when the limbs are not 4-byte aligned or the host is not little-endian.
+size_t deserialize(uint8_t const *in, size_t size, big_integer_view &out, binary_format format = binary_format::fixed);
+
+// A view as an operand of lazy expressions, e.g.
+//
+//     assign(r, lazy(view) * b % m);
+struct expr_view_leaf : big_integer_expr<expr_view_leaf>
+{
+    static const size_t terms = 1;
+    big_integer_view value;
+
+    explicit expr_view_leaf(big_integer_view const &v) : value(v) {}
+
+    size_t limbs_bound() const
+    {
+        return this->value.size;
+    }
+
+    size_t scratch_bound() const
+    {
+        return 0;
+    }
+
+    void collect(expr_term *&out, bool negate, expr_scratch &) const
+    {
+        expr_term t = {this->value.limbs, this->value.size, this->value.neg != negate};
+        *out++ = t;
+    }
+};
+
+inline expr_view_leaf lazy(big_integer_view const &a)
+{
+    return expr_view_leaf(a);
+}
+
+#endif //BIG_INTEGER_BINARY_H
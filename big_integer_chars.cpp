@@ -0,0 +1,53 @@
+#include "big_integer_chars.h"
+#include "big_integer_expr.h"
+#include "limb_ops.h"
+#include "radix_conversion.h"
+
+big_integer_from_chars_result from_chars(char const *first, char const *last, big_integer &value, int base)
+{
+    big_integer_from_chars_result res = {first, std::errc::invalid_argument};
+    if (base < 2 || base > 36) return res;
+
+    char const *digits = first != last && *first == '-' ? first + 1 : first;
+    char const *end = digits;
+    while (end != last && radix_digit_value(*end) < static_cast<unsigned>(base)) ++end;
+    if (end == digits) return res;
+
+    size_t len = static_cast<size_t>(end - digits);
+    uint32_t *r = big_integer_expr_access::prepare(value, radix_limbs_bound(len, static_cast<unsigned>(base)));
+    size_t n = limbs_from_radix_to(digits, len, static_cast<unsigned>(base), r);
+    big_integer_expr_access::finish(value, n, digits != first);
+    res.ptr = end;
+    res.ec = std::errc();
+    return res;
+}
+
+big_integer_to_chars_result to_chars(char *first, char *last, big_integer const &value, int base)
+{
+    big_integer_to_chars_result res = {last, std::errc::value_too_large};
+    if (base < 2 || base > 36)
+    {
+        res.ec = std::errc::invalid_argument;
+        return res;
+    }
+
+    expr_term t = big_integer_expr_access::term(value);
+    char *p = first;
+    if (t.neg)
+    {
+        if (p == last) return res;
+        *p++ = '-';
+    }
+    size_t len = limbs_to_radix(t.limbs, t.size, static_cast<unsigned>(base), false, p, static_cast<size_t>(last - p));
+    if (len == 0) return res;
+    res.ptr = p + len;
+    res.ec = std::errc();
+    return res;
+}
+
+size_t digits_upper_bound(big_integer const &value, int base)
+{
+    expr_term t = big_integer_expr_access::term(value);
+    size_t bits = t.size == 0 ? 0 : (t.size - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clz(t.limbs[t.size - 1]));
+    return (t.neg ? 1 : 0) + radix_digits_bound(bits, static_cast<unsigned>(base));
+}
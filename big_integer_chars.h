@@ -0,0 +1,47 @@
+#ifndef BIG_INTEGER_CHARS_H
+#define BIG_INTEGER_CHARS_H
+
+#include <stddef.h>
+#include <system_error>
+#include "big_integer.h"
+
+// Conversions in the manner of std::from_chars and std::to_chars: no
+// locale, no whitespace, no terminator, errors as std::errc, and no memory
+// beyond the caller's characters and the value's own limbs.
+
+struct big_integer_from_chars_result
+{
+    char const *ptr;
+    std::errc ec;
+};
+
+struct big_integer_to_chars_result
+{
+    char *ptr;
+    std::errc ec;
+};
+
+// Parses an optional '-' and then the longest run of digits of base (2 to
+// 36, either case) at first; no '+', base prefix or whitespace. ptr is
+// past the digits. With none there, or a bad base, ec is invalid_argument,
+// ptr is first and value is left alone.
+//
+// value's limb buffer is reused when it is large enough and otherwise
+// allocated once at the final size; the digits are packed straight into
+// it. Only input beyond RADIX_INPLACE_CHUNKS limbs in a base that is not
+// a power of two (about 2900 decimal digits) takes scratch, for the
+// divide-and-conquer conversion that keeps it from being quadratic.
+big_integer_from_chars_result from_chars(char const *first, char const *last, big_integer &value, int base = 10);
+
+// Writes a '-' when value is negative and then its digits in base (2 to
+// 36), lowercase. ptr is past the last character written. When the range
+// is too short, ec is value_too_large, ptr is last and the range holds
+// unspecified characters. Values of RADIX_DC_THRESHOLD limbs or more in a
+// base that is not a power of two take scratch as from_chars does.
+big_integer_to_chars_result to_chars(char *first, char *last, big_integer const &value, int base = 10);
+
+// At least the number of characters to_chars writes for value, sign
+// included, from its bit length alone; exact for power-of-two bases.
+size_t digits_upper_bound(big_integer const &value, int base = 10);
+
+#endif //BIG_INTEGER_CHARS_H
@@ -0,0 +1,117 @@
+#include "big_integer_expr.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include "div_engine.h"
+#include <algorithm>
+#include <functional>
+
+expr_term big_integer_expr_access::term(big_integer const &a)
+{
+    expr_term res;
+    res.limbs = a.data.data();
+    res.size = limbs_normalized_size(res.limbs, a.data.size());
+    res.neg = !a.sign && res.size != 0;
+    return res;
+}
+
+void big_integer_expr_access::assign(big_integer &dst, uint32_t const *limbs, size_t n, bool neg)
+{
+    if (n == 0)
+    {
+        dst = big_integer();
+        return;
+    }
+    dst.data.assign(limbs, n);
+    dst.sign = !neg;
+}
+
+uint32_t *big_integer_expr_access::prepare(big_integer &dst, size_t n)
+{
+    // Nothing in a block that is too small is worth copying over.
+    if (dst.data.capacity() < n) dst.data.resize(0);
+    dst.data.resize(n);
+    return dst.data.mutable_data();
+}
+
+void big_integer_expr_access::finish(big_integer &dst, size_t n, bool neg)
+{
+    if (n == 0)
+    {
+        dst.data.resize(1);
+        dst.data.mutable_data()[0] = 0;
+        dst.sign = true;
+        return;
+    }
+    dst.data.resize(n);
+    dst.sign = !neg;
+}
+
+bool big_integer_expr_access::holds(big_integer const &a, uint32_t const *p)
+{
+    uint32_t const *begin = a.data.data();
+    std::less<uint32_t const *> less;
+    return !less(p, begin) && less(p, begin + a.data.capacity());
+}
+
+size_t expr_sum(uint32_t *r, size_t rn, expr_term const *terms, size_t count, bool &neg)
+{
+    // One pass over every term with a signed carry; the arithmetic shift
+    // floors, leaving the low limb in [0, B).
+    int64_t carry = 0;
+    for (size_t i = 0; i < rn; ++i)
+    {
+        int64_t acc = carry;
+        for (size_t t = 0; t < count; ++t)
+        {
+            if (i < terms[t].size)
+            {
+                acc += terms[t].neg ? -static_cast<int64_t>(terms[t].limbs[i]) : terms[t].limbs[i];
+            }
+        }
+        carry = acc >> LIMB_BITS;
+        r[i] = static_cast<uint32_t>(acc);
+    }
+
+    // A negative sum is left as B^rn - |sum|; turn it back into a magnitude.
+    neg = carry < 0;
+    if (neg)
+    {
+        for (size_t i = 0; i < rn; ++i)
+        {
+            r[i] = ~r[i];
+        }
+        limbs_add_1(r, r, rn, 1);
+    }
+    return limbs_normalized_size(r, rn);
+}
+
+expr_term expr_mul(expr_scratch &scratch, expr_term const &a, expr_term const &b)
+{
+    expr_term res;
+    res.limbs = 0;
+    res.size = 0;
+    res.neg = false;
+    if (a.size == 0 || b.size == 0) return res;
+
+    uint32_t *r = scratch.take(a.size + b.size);
+    mul_limbs(r, a.limbs, a.size, b.limbs, b.size);
+    res.limbs = r;
+    res.size = limbs_normalized_size(r, a.size + b.size);
+    res.neg = a.neg != b.neg;
+    return res;
+}
+
+expr_term expr_mod(expr_scratch &scratch, expr_term const &a, expr_term const &m)
+{
+    if (limbs_cmp(a.limbs, a.size, m.limbs, m.size) < 0) return a;
+
+    uint32_t *q = scratch.take(a.size - m.size + 1);
+    uint32_t *r = scratch.take(m.size);
+    div_limbs(q, r, a.limbs, a.size, m.limbs, m.size);
+
+    expr_term res;
+    res.limbs = r;
+    res.size = limbs_normalized_size(r, m.size);
+    res.neg = a.neg && res.size != 0;
+    return res;
+}
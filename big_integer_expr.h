@@ -0,0 +1,309 @@
+#ifndef BIG_INTEGER_EXPR_H
+#define BIG_INTEGER_EXPR_H
+
+#include <vector>
+#include "big_integer.h"
+
+// Opt-in lazy evaluation for compound expressions:
+//
+//     assign(r, (lazy(a) * b + c) % m);
+//
+// builds an expression tree without touching the heap, then evaluates it
+// with one scratch allocation (sized up front from operand limb counts),
+// summing straight into r's limbs: its block is reused when it is large
+// enough, otherwise allocated once. When r is itself an operand the sum
+// goes through a separate buffer first. Chains of + and - are summed in a
+// single pass over all of their terms.
+
+// A signed operand of an evaluation step, pointing into a big_integer or
+// into the scratch buffer.
+struct expr_term
+{
+    uint32_t const *limbs;
+    size_t size;
+    bool neg;
+};
+
+struct expr_scratch
+{
+    std::vector<uint32_t> buf;
+    size_t used;
+
+    explicit expr_scratch(size_t n) : buf(n), used(0) {}
+
+    uint32_t *take(size_t n)
+    {
+        uint32_t *res = buf.data() + used;
+        used += n;
+        return res;
+    }
+};
+
+struct big_integer_expr_access
+{
+    static expr_term term(big_integer const &a);
+    // dst = (neg ? -1 : 1) * limbs[0, n), n normalized.
+    static void assign(big_integer &dst, uint32_t const *limbs, size_t n, bool neg);
+    // dst's own limbs, n of them (n >= 1) and unshared, for building a
+    // result in place; its heap block is kept when it is large enough.
+    static uint32_t *prepare(big_integer &dst, size_t n);
+    // Ends a prepare(): dst = (neg ? -1 : 1) * its first n limbs, n normalized.
+    static void finish(big_integer &dst, size_t n, bool neg);
+    // Whether p points into a's limb storage.
+    static bool holds(big_integer const &a, uint32_t const *p);
+};
+
+// r[0, rn) = sum of terms. rn must exceed every term size by one limb.
+// Returns the normalized length and sets neg to the sign of the sum.
+size_t expr_sum(uint32_t *r, size_t rn, expr_term const *terms, size_t count, bool &neg);
+expr_term expr_mul(expr_scratch &scratch, expr_term const &a, expr_term const &b);
+expr_term expr_mod(expr_scratch &scratch, expr_term const &a, expr_term const &m);
+
+template <class E>
+struct big_integer_expr
+{
+    E const &self() const
+    {
+        return static_cast<E const &>(*this);
+    }
+};
+
+// Scratch an operand needs to be turned into a single term.
+template <class E>
+size_t expr_eval_bound(E const &e)
+{
+    return e.scratch_bound() + (E::terms > 1 ? e.limbs_bound() + 1 : 0);
+}
+
+template <class E>
+expr_term expr_eval(E const &e, expr_scratch &scratch)
+{
+    expr_term terms[E::terms];
+    expr_term *out = terms;
+    e.collect(out, false, scratch);
+    if (E::terms == 1) return terms[0];
+
+    size_t rn = e.limbs_bound() + 1;
+    expr_term res;
+    uint32_t *r = scratch.take(rn);
+    res.limbs = r;
+    res.size = expr_sum(r, rn, terms, E::terms, res.neg);
+    return res;
+}
+
+struct expr_leaf : big_integer_expr<expr_leaf>
+{
+    static const size_t terms = 1;
+    big_integer const &value;
+
+    explicit expr_leaf(big_integer const &v) : value(v) {}
+
+    size_t limbs_bound() const
+    {
+        return big_integer_expr_access::term(value).size;
+    }
+
+    size_t scratch_bound() const
+    {
+        return 0;
+    }
+
+    void collect(expr_term *&out, bool negate, expr_scratch &) const
+    {
+        expr_term t = big_integer_expr_access::term(value);
+        t.neg = t.neg != negate;
+        *out++ = t;
+    }
+};
+
+template <class L, class R, bool Sub>
+struct expr_add_node : big_integer_expr<expr_add_node<L, R, Sub> >
+{
+    static const size_t terms = L::terms + R::terms;
+    L left;
+    R right;
+
+    expr_add_node(L const &l, R const &r) : left(l), right(r) {}
+
+    size_t limbs_bound() const
+    {
+        size_t l = left.limbs_bound();
+        size_t r = right.limbs_bound();
+        return (l > r ? l : r) + 1;
+    }
+
+    size_t scratch_bound() const
+    {
+        return left.scratch_bound() + right.scratch_bound();
+    }
+
+    void collect(expr_term *&out, bool negate, expr_scratch &scratch) const
+    {
+        left.collect(out, negate, scratch);
+        right.collect(out, negate != Sub, scratch);
+    }
+};
+
+template <class L, class R>
+struct expr_mul_node : big_integer_expr<expr_mul_node<L, R> >
+{
+    static const size_t terms = 1;
+    L left;
+    R right;
+
+    expr_mul_node(L const &l, R const &r) : left(l), right(r) {}
+
+    size_t limbs_bound() const
+    {
+        return left.limbs_bound() + right.limbs_bound() + 2;
+    }
+
+    size_t scratch_bound() const
+    {
+        return expr_eval_bound(left) + expr_eval_bound(right) + limbs_bound();
+    }
+
+    void collect(expr_term *&out, bool negate, expr_scratch &scratch) const
+    {
+        expr_term t = expr_mul(scratch, expr_eval(left, scratch), expr_eval(right, scratch));
+        t.neg = t.neg != negate;
+        *out++ = t;
+    }
+};
+
+template <class L, class R>
+struct expr_mod_node : big_integer_expr<expr_mod_node<L, R> >
+{
+    static const size_t terms = 1;
+    L left;
+    R right;
+
+    expr_mod_node(L const &l, R const &r) : left(l), right(r) {}
+
+    size_t limbs_bound() const
+    {
+        return right.limbs_bound();
+    }
+
+    size_t scratch_bound() const
+    {
+        return expr_eval_bound(left) + expr_eval_bound(right) + left.limbs_bound() + right.limbs_bound() + 2;
+    }
+
+    void collect(expr_term *&out, bool negate, expr_scratch &scratch) const
+    {
+        expr_term t = expr_mod(scratch, expr_eval(left, scratch), expr_eval(right, scratch));
+        t.neg = t.neg != negate;
+        *out++ = t;
+    }
+};
+
+inline expr_leaf lazy(big_integer const &a)
+{
+    return expr_leaf(a);
+}
+
+template <class E>
+void assign(big_integer &dst, big_integer_expr<E> const &expr)
+{
+    E const &e = expr.self();
+    expr_scratch scratch(e.scratch_bound());
+    expr_term terms[E::terms];
+    expr_term *out = terms;
+    e.collect(out, false, scratch);
+
+    bool aliased = false;
+    for (size_t i = 0; i < E::terms; ++i)
+    {
+        aliased = aliased || (terms[i].size != 0 && big_integer_expr_access::holds(dst, terms[i].limbs));
+    }
+
+    size_t rn = e.limbs_bound() + 1;
+    bool neg;
+    if (aliased)
+    {
+        std::vector<uint32_t> limbs(rn);
+        size_t n = expr_sum(&limbs[0], rn, terms, E::terms, neg);
+        big_integer_expr_access::assign(dst, limbs.data(), n, neg);
+        return;
+    }
+    uint32_t *r = big_integer_expr_access::prepare(dst, rn);
+    size_t n = expr_sum(r, rn, terms, E::terms, neg);
+    big_integer_expr_access::finish(dst, n, neg);
+}
+
+template <class E>
+big_integer eval(big_integer_expr<E> const &expr)
+{
+    big_integer res;
+    assign(res, expr);
+    return res;
+}
+
+template <class L, class R>
+expr_add_node<L, R, false> operator+(big_integer_expr<L> const &l, big_integer_expr<R> const &r)
+{
+    return expr_add_node<L, R, false>(l.self(), r.self());
+}
+
+template <class L>
+expr_add_node<L, expr_leaf, false> operator+(big_integer_expr<L> const &l, big_integer const &r)
+{
+    return expr_add_node<L, expr_leaf, false>(l.self(), expr_leaf(r));
+}
+
+template <class R>
+expr_add_node<expr_leaf, R, false> operator+(big_integer const &l, big_integer_expr<R> const &r)
+{
+    return expr_add_node<expr_leaf, R, false>(expr_leaf(l), r.self());
+}
+
+template <class L, class R>
+expr_add_node<L, R, true> operator-(big_integer_expr<L> const &l, big_integer_expr<R> const &r)
+{
+    return expr_add_node<L, R, true>(l.self(), r.self());
+}
+
+template <class L>
+expr_add_node<L, expr_leaf, true> operator-(big_integer_expr<L> const &l, big_integer const &r)
+{
+    return expr_add_node<L, expr_leaf, true>(l.self(), expr_leaf(r));
+}
+
+template <class R>
+expr_add_node<expr_leaf, R, true> operator-(big_integer const &l, big_integer_expr<R> const &r)
+{
+    return expr_add_node<expr_leaf, R, true>(expr_leaf(l), r.self());
+}
+
+template <class L, class R>
+expr_mul_node<L, R> operator*(big_integer_expr<L> const &l, big_integer_expr<R> const &r)
+{
+    return expr_mul_node<L, R>(l.self(), r.self());
+}
+
+template <class L>
+expr_mul_node<L, expr_leaf> operator*(big_integer_expr<L> const &l, big_integer const &r)
+{
+    return expr_mul_node<L, expr_leaf>(l.self(), expr_leaf(r));
+}
+
+template <class R>
+expr_mul_node<expr_leaf, R> operator*(big_integer const &l, big_integer_expr<R> const &r)
+{
+    return expr_mul_node<expr_leaf, R>(expr_leaf(l), r.self());
+}
+
+template <class L, class R>
+expr_mod_node<L, R> operator%(big_integer_expr<L> const &l, big_integer_expr<R> const &r)
+{
+    return expr_mod_node<L, R>(l.self(), r.self());
+}
+
+template <class L>
+expr_mod_node<L, expr_leaf> operator%(big_integer_expr<L> const &l, big_integer const &r)
+{
+    return expr_mod_node<L, expr_leaf>(l.self(), expr_leaf(r));
+}
+
+#endif // BIG_INTEGER_EXPR_H
@@ -0,0 +1,157 @@
+#include "big_integer_store.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = {'B', 'I', 'G', 'S', 'T', 'O', 'R', 'E'};
+static const uint32_t VERSION = 1;
+static const size_t HEADER_SIZE = 32;
+static const size_t SLOT_SIZE = 16;
+static const size_t RECORD_ALIGN = 8;
+
+static void put_u32(uint8_t *p, uint32_t x)
+{
+    for (size_t i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(x >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t x)
+{
+    for (size_t i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(x >> (8 * i));
+}
+
+static uint32_t get_u32(uint8_t const *p)
+{
+    uint32_t x = 0;
+    for (size_t i = 0; i < 4; ++i) x |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return x;
+}
+
+static uint64_t get_u64(uint8_t const *p)
+{
+    uint64_t x = 0;
+    for (size_t i = 0; i < 8; ++i) x |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return x;
+}
+
+// Spreads consecutive keys over the table (the splitmix64 finalizer).
+static uint64_t slot_hash(uint64_t key)
+{
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+bool big_integer_store_writer::add(uint64_t key, big_integer const &value)
+{
+    if (!this->keys.insert(key).second) return false;
+
+    big_integer_view v(value);
+    size_t at = this->records.size();
+    size_t n = serialized_size(v);
+    this->records.resize(at + (n + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN);
+    serialize_to(v, &this->records[at], n);
+    entry e = {key, at};
+    this->entries.push_back(e);
+    return true;
+}
+
+bool big_integer_store_writer::write(std::string const &path) const
+{
+    // At most half the slots are taken, so every probe sequence ends.
+    uint64_t slot_count = 1;
+    while (slot_count < 2 * this->entries.size()) slot_count *= 2;
+    uint64_t records_at = HEADER_SIZE + SLOT_SIZE * slot_count;
+
+    std::vector<uint8_t> head(static_cast<size_t>(records_at));
+    std::memcpy(&head[0], MAGIC, sizeof(MAGIC));
+    put_u32(&head[8], VERSION);
+    put_u64(&head[16], this->entries.size());
+    put_u64(&head[24], slot_count);
+    for (size_t i = 0; i < this->entries.size(); ++i)
+    {
+        uint64_t s = slot_hash(this->entries[i].key) & (slot_count - 1);
+        while (get_u64(&head[HEADER_SIZE + SLOT_SIZE * s + 8]) != 0) s = (s + 1) & (slot_count - 1);
+        put_u64(&head[HEADER_SIZE + SLOT_SIZE * s], this->entries[i].key);
+        put_u64(&head[HEADER_SIZE + SLOT_SIZE * s + 8], records_at + this->entries[i].offset);
+    }
+
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (f == 0) return false;
+    bool ok = std::fwrite(&head[0], 1, head.size(), f) == head.size();
+    if (ok && !this->records.empty())
+    {
+        ok = std::fwrite(&this->records[0], 1, this->records.size(), f) == this->records.size();
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+big_integer_store::big_integer_store() : base(0), length(0), count(0), slot_count(0) {}
+
+big_integer_store::~big_integer_store()
+{
+    this->close();
+}
+
+void big_integer_store::close()
+{
+    if (this->base != 0) munmap(const_cast<uint8_t *>(this->base), this->length);
+    this->base = 0;
+    this->length = 0;
+    this->count = 0;
+    this->slot_count = 0;
+}
+
+bool big_integer_store::open(std::string const &path)
+{
+    this->close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= HEADER_SIZE)
+    {
+        map = mmap(0, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    this->base = static_cast<uint8_t const *>(map);
+    this->length = static_cast<size_t>(st.st_size);
+
+    uint64_t count = get_u64(this->base + 16);
+    uint64_t slot_count = get_u64(this->base + 24);
+    if (std::memcmp(this->base, MAGIC, sizeof(MAGIC)) != 0 || get_u32(this->base + 8) != VERSION ||
+        slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+        slot_count > (this->length - HEADER_SIZE) / SLOT_SIZE || count > slot_count / 2)
+    {
+        this->close();
+        return false;
+    }
+    this->count = static_cast<size_t>(count);
+    this->slot_count = slot_count;
+    return true;
+}
+
+bool big_integer_store::find(uint64_t key, big_integer_view &out) const
+{
+    if (this->base == 0) return false;
+    uint8_t const *slots = this->base + HEADER_SIZE;
+    uint64_t s = slot_hash(key) & (this->slot_count - 1);
+    for (uint64_t probes = 0; probes < this->slot_count; ++probes, s = (s + 1) & (this->slot_count - 1))
+    {
+        uint8_t const *slot = slots + SLOT_SIZE * s;
+        uint64_t offset = get_u64(slot + 8);
+        if (offset == 0) return false;
+        if (get_u64(slot) != key) continue;
+        if (offset >= this->length) return false;
+        big_integer_view v;
+        if (deserialize(this->base + offset, this->length - static_cast<size_t>(offset), v) == 0) return false;
+        out = v;
+        return true;
+    }
+    return false;
+}
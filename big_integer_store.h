@@ -0,0 +1,76 @@
+#ifndef BIG_INTEGER_STORE_H
+#define BIG_INTEGER_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "big_integer.h"
+#include "big_integer_binary.h"
+
+// A file of big_integer values keyed by 64-bit integers, read through
+// mmap. Layout, all little-endian:
+//
+//   header   "BIGSTORE", version, value count, slot count (a power of two)
+//   slots    {key, record offset} pairs, an open-addressing table with
+//            linear probing; offset 0 marks an empty slot
+//   records  each value in binary_format::fixed at an 8-byte boundary
+//
+// A lookup probes the table and points a view at the record's limbs, so
+// opening and reading parse nothing and allocate nothing.
+
+// Collects values, then writes the file in one go.
+struct big_integer_store_writer
+{
+    // False, changing nothing, when key is already present.
+    bool add(uint64_t key, big_integer const &value);
+    size_t size() const
+    {
+        return this->entries.size();
+    }
+    // Writes the store to path, replacing any file there. False on I/O errors.
+    bool write(std::string const &path) const;
+
+private:
+    struct entry
+    {
+        uint64_t key;
+        uint64_t offset;
+    };
+
+    std::vector<entry> entries;
+    std::unordered_set<uint64_t> keys;
+    std::vector<uint8_t> records;
+};
+
+// Read-only mapping of a store file. Views it hands out stay valid until
+// the store is closed or destroyed.
+struct big_integer_store
+{
+    big_integer_store();
+    ~big_integer_store();
+    big_integer_store(big_integer_store const &) = delete;
+    big_integer_store &operator=(big_integer_store const &) = delete;
+
+    // Maps path, closing any previous file. False when it cannot be mapped
+    // or is not a store; the store is then empty.
+    bool open(std::string const &path);
+    void close();
+
+    size_t size() const
+    {
+        return this->count;
+    }
+    // Points out at the value stored under key. False, leaving out alone,
+    // when there is none.
+    bool find(uint64_t key, big_integer_view &out) const;
+
+private:
+    uint8_t const *base;
+    size_t length;
+    size_t count;
+    uint64_t slot_count;
+};
+
+#endif //BIG_INTEGER_STORE_H
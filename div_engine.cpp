@@ -0,0 +1,136 @@
+#include "div_engine.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include <vector>
+#include <algorithm>
+
+void div_basecase(uint32_t *q, uint32_t *u, size_t un, uint32_t const *v, size_t vn)
+{
+    uint64_t v1 = v[vn - 1];
+    uint64_t v2 = v[vn - 2];
+
+    for (size_t j = un - vn; j-- > 0;)
+    {
+        uint64_t top = static_cast<uint64_t>(u[j + vn]) << LIMB_BITS | u[j + vn - 1];
+        uint64_t qhat = top / v1;
+        uint64_t rhat = top % v1;
+        while (qhat > LIMB_MAX || qhat * v2 > (rhat << LIMB_BITS | u[j + vn - 2]))
+        {
+            --qhat;
+            rhat += v1;
+            if (rhat > LIMB_MAX) break;
+        }
+
+        uint32_t hi = limbs_submul_1(u + j, v, vn, static_cast<uint32_t>(qhat));
+        if (u[j + vn] < hi)
+        {
+            --qhat;
+            limbs_add(u + j, u + j, vn, v, vn);
+        }
+        u[j + vn] = 0;
+        q[j] = static_cast<uint32_t>(qhat);
+    }
+}
+
+static void div_3n_2n(uint32_t *q, uint32_t *a, uint32_t const *b, size_t k);
+
+// a has 2n limbs and a[n, 2n) < b. Writes n quotient limbs to q, leaves the
+// remainder in a[0, n) and zeroes a[n, 2n).
+static void div_2n_1n(uint32_t *q, uint32_t *a, uint32_t const *b, size_t n)
+{
+    if (n % 2 != 0 || n < BZ_THRESHOLD)
+    {
+        div_basecase(q, a, 2 * n, b, n);
+        return;
+    }
+
+    size_t k = n / 2;
+    div_3n_2n(q + k, a + k, b, k);
+    div_3n_2n(q, a, b, k);
+}
+
+// a has 3k limbs and a[k, 3k) < b, where b has 2k limbs. Writes k quotient
+// limbs to q, leaves the remainder in a[0, 2k) and zeroes a[2k, 3k).
+static void div_3n_2n(uint32_t *q, uint32_t *a, uint32_t const *b, size_t k)
+{
+    uint32_t const *b1 = b + k;
+    uint32_t const *b2 = b;
+    uint32_t extra = 0;
+
+    if (limbs_cmp(a + 2 * k, k, b1, k) < 0)
+    {
+        // q = [a1 a2] / b1, remainder left in a[k, 2k).
+        div_2n_1n(q, a + k, b1, k);
+    }
+    else
+    {
+        // a1 == b1 here: q = B^k - 1 and the remainder is a2 + b1.
+        std::fill(q, q + k, LIMB_MAX);
+        std::fill(a + 2 * k, a + 3 * k, 0);
+        extra = limbs_add(a + k, a + k, k, b1, k);
+    }
+
+    std::vector<uint32_t> d(2 * k);
+    mul_limbs(&d[0], q, k, b2, k);
+    int64_t top = static_cast<int64_t>(extra) - limbs_sub(a, a, 2 * k, &d[0], 2 * k);
+
+    // q overestimates by at most two.
+    while (top < 0)
+    {
+        top += limbs_add(a, a, 2 * k, b, 2 * k);
+        limbs_sub_1(q, q, k, 1);
+    }
+}
+
+void div_limbs(uint32_t *q, uint32_t *r, uint32_t const *u, size_t un, uint32_t const *v, size_t vn)
+{
+    if (vn == 1)
+    {
+        r[0] = limbs_divrem_1(q, u, un, v[0]);
+        return;
+    }
+
+    // Normalize so that the top bit of v is set.
+    unsigned shift = static_cast<unsigned>(__builtin_clz(v[vn - 1]));
+
+    if (vn < BZ_THRESHOLD)
+    {
+        std::vector<uint32_t> nv(vn), nu(un + 1);
+        limbs_lshift(&nv[0], v, vn, shift);
+        nu[un] = limbs_lshift(&nu[0], u, un, shift);
+        div_basecase(q, &nu[0], un + 1, &nv[0], vn);
+        limbs_rshift(r, &nu[0], vn, shift);
+        return;
+    }
+
+    // Pad the divisor with s low zero limbs to n = m * 2^j limbs, m below the
+    // threshold, so that div_2n_1n halves evenly down to the base case.
+    size_t m = vn;
+    size_t j = 0;
+    while (m >= BZ_THRESHOLD)
+    {
+        m = (m + 1) / 2;
+        ++j;
+    }
+    size_t n = m << j;
+    size_t s = n - vn;
+
+    std::vector<uint32_t> nv(n, 0);
+    limbs_lshift(&nv[s], v, vn, shift);
+
+    size_t len = un + 1 + s;
+    size_t blocks = (len + n - 1) / n;
+    std::vector<uint32_t> nu((blocks + 1) * n, 0);
+    nu[s + un] = limbs_lshift(&nu[s], u, un, shift);
+    if (limbs_cmp(&nu[(blocks - 1) * n], n, &nv[0], n) >= 0) ++blocks;
+
+    std::vector<uint32_t> nq((blocks - 1) * n);
+    for (size_t i = blocks - 1; i-- > 0;)
+    {
+        div_2n_1n(&nq[i * n], &nu[i * n], &nv[0], n);
+    }
+
+    std::copy(nq.begin(), nq.begin() + std::min(nq.size(), un - vn + 1), q);
+    std::fill(q + std::min(nq.size(), un - vn + 1), q + un - vn + 1, 0);
+    limbs_rshift(r, &nu[s], vn, shift);
+}
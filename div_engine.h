@@ -0,0 +1,20 @@
+#ifndef BIGINT_DIV_ENGINE_H
+#define BIGINT_DIV_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Divisor length (in limbs) from which div_limbs switches from Knuth's
+// algorithm D to Burnikel-Ziegler recursive division.
+const size_t BZ_THRESHOLD = 60;
+
+// q = u / v, r = u % v. Requires un >= vn and a nonzero top limb in v.
+// q has un - vn + 1 limbs, r has vn limbs; neither may overlap u or v.
+void div_limbs(uint32_t *q, uint32_t *r, uint32_t const *u, size_t un, uint32_t const *v, size_t vn);
+
+// Knuth's algorithm D, in place. v is normalized (top limb at least B / 2),
+// vn >= 2 and the top vn limbs of u are below v. Writes un - vn quotient
+// limbs to q and leaves the remainder in u[0, vn), zeroing the rest of u.
+void div_basecase(uint32_t *q, uint32_t *u, size_t un, uint32_t const *v, size_t vn);
+
+#endif //BIGINT_DIV_ENGINE_H
@@ -0,0 +1,576 @@
+#ifndef BIGINT_FIXED_BIG_INTEGER_H
+#define BIGINT_FIXED_BIG_INTEGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "big_integer.h"
+#include "big_integer_expr.h"
+#include "radix_conversion.h"
+
+// An integer of exactly Bits bits, a multiple of 32, kept as a limb array
+// inside the object: no heap block, no size, and loops over a compile-time
+// number of limbs that the compiler unrolls. Arithmetic wraps modulo
+// 2^Bits like the built-in unsigned types. Signed values are two's
+// complement; they divide towards zero and shift right with floor, as
+// big_integer does. The operators are big_integer's, and conversions go
+// both ways, so hot code can switch between the two without rewriting.
+// From C++14 on, everything that does not touch big_integer or strings is
+// constexpr.
+
+#if __cplusplus >= 201402L
+#define BIGINT_CONSTEXPR14 constexpr
+#else
+#define BIGINT_CONSTEXPR14
+#endif
+
+template <size_t... I>
+struct fixed_index_list
+{
+};
+
+template <size_t N, size_t... I>
+struct make_fixed_index_list : make_fixed_index_list<N - 1, N - 1, I...>
+{
+};
+
+template <size_t... I>
+struct make_fixed_index_list<0, I...>
+{
+    typedef fixed_index_list<I...> type;
+};
+
+// Calls f(0), ..., f(N - 1) with no loop left for the optimizer to keep.
+// F is a function object rather than a lambda so that it can run in a
+// constant expression.
+template <size_t N>
+struct fixed_unroll
+{
+    template <class F>
+    static BIGINT_CONSTEXPR14 void run(F const& f)
+    {
+        fixed_unroll<N - 1>::run(f);
+        f(N - 1);
+    }
+};
+
+template <>
+struct fixed_unroll<0>
+{
+    template <class F>
+    static BIGINT_CONSTEXPR14 void run(F const&)
+    {
+    }
+};
+
+template <size_t Bits, bool Signed = false>
+struct fixed_big_integer
+{
+    static_assert(Bits != 0 && Bits % 32 == 0, "Bits must be a positive multiple of 32");
+    static const size_t limb_count = Bits / 32;
+
+    constexpr fixed_big_integer() : limbs() {}
+
+    // Converts as built-in integers do: sign-extended, then wrapped.
+    template <class T, class = typename std::enable_if<std::is_integral<T>::value>::type>
+    constexpr fixed_big_integer(T x)
+        : fixed_big_integer(static_cast<uint64_t>(x), std::is_signed<T>::value && static_cast<int64_t>(x) < 0,
+                            typename make_fixed_index_list<limb_count>::type())
+    {
+    }
+
+    // a modulo 2^Bits.
+    explicit fixed_big_integer(big_integer const& a) : limbs()
+    {
+        expr_term t = big_integer_expr_access::term(a);
+        for (size_t i = 0; i < limb_count && i < t.size; ++i) this->limbs[i] = t.limbs[i];
+        if (t.neg) this->negate();
+    }
+
+    // Decimal, as big_integer's constructor reads it.
+    explicit fixed_big_integer(std::string const& str) : fixed_big_integer(big_integer(str)) {}
+
+    template <size_t OtherBits, bool OtherSigned>
+    explicit BIGINT_CONSTEXPR14 fixed_big_integer(fixed_big_integer<OtherBits, OtherSigned> const& a) : limbs()
+    {
+        uint32_t fill = a.is_negative() ? 0xffffffffu : 0;
+        for (size_t i = 0; i < limb_count; ++i)
+        {
+            this->limbs[i] = i < a.limb_count ? a.data()[i] : fill;
+        }
+    }
+
+    big_integer to_big_integer() const
+    {
+        bool neg = this->is_negative();
+        fixed_big_integer abs = neg ? -*this : *this;
+        big_integer res;
+        big_integer_expr_access::assign(res, abs.limbs, size_of(abs.limbs), neg);
+        return res;
+    }
+
+    explicit operator big_integer() const
+    {
+        return this->to_big_integer();
+    }
+
+    // The limbs, lowest first, in two's complement when Signed.
+    constexpr uint32_t const* data() const
+    {
+        return this->limbs;
+    }
+
+    BIGINT_CONSTEXPR14 bool is_zero() const
+    {
+        return size_of(this->limbs) == 0;
+    }
+
+    constexpr bool is_negative() const
+    {
+        return Signed && (this->limbs[limb_count - 1] >> 31) != 0;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator+=(fixed_big_integer const& rhs)
+    {
+        uint64_t carry = 0;
+        fixed_unroll<limb_count>::run(add_step{this->limbs, rhs.limbs, &carry});
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator-=(fixed_big_integer const& rhs)
+    {
+        uint64_t borrow = 0;
+        fixed_unroll<limb_count>::run(sub_step{this->limbs, rhs.limbs, &borrow});
+        return *this;
+    }
+
+    // Only the products landing below 2^Bits are formed, about half of them;
+    // the low half of a product is the same for either signedness.
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator*=(fixed_big_integer const& rhs)
+    {
+        uint32_t r[limb_count] = {};
+        fixed_unroll<limb_count>::run(mul_row{r, this->limbs, rhs.limbs});
+        for (size_t i = 0; i < limb_count; ++i) this->limbs[i] = r[i];
+        return *this;
+    }
+
+    // rhs must be nonzero, as for every division here.
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator/=(fixed_big_integer const& rhs)
+    {
+        fixed_big_integer rem;
+        return this->div_rem(rhs, rem);
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator%=(fixed_big_integer const& rhs)
+    {
+        fixed_big_integer quot = *this;
+        quot.div_rem(rhs, *this);
+        return *this;
+    }
+
+    // *this becomes the quotient truncated towards zero, rem the remainder
+    // with the sign of the dividend. rem must not be *this.
+    BIGINT_CONSTEXPR14 fixed_big_integer& div_rem(fixed_big_integer const& rhs, fixed_big_integer& rem)
+    {
+        bool neg = this->is_negative(), rhs_neg = rhs.is_negative();
+        fixed_big_integer u = neg ? -*this : *this;
+        fixed_big_integer v = rhs_neg ? -rhs : rhs;
+        divide(u.limbs, v.limbs, this->limbs, rem.limbs);
+        if (neg != rhs_neg) this->negate();
+        if (neg) rem.negate();
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator&=(fixed_big_integer const& rhs)
+    {
+        for (size_t i = 0; i < limb_count; ++i) this->limbs[i] &= rhs.limbs[i];
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator|=(fixed_big_integer const& rhs)
+    {
+        for (size_t i = 0; i < limb_count; ++i) this->limbs[i] |= rhs.limbs[i];
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator^=(fixed_big_integer const& rhs)
+    {
+        for (size_t i = 0; i < limb_count; ++i) this->limbs[i] ^= rhs.limbs[i];
+        return *this;
+    }
+
+    // Bits shifted past the top are lost; a negative count shifts right.
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator<<=(int rhs)
+    {
+        if (rhs < 0) return *this >>= -rhs;
+        size_t blocks = static_cast<size_t>(rhs) / 32;
+        unsigned bits = static_cast<unsigned>(rhs) % 32;
+        for (size_t i = limb_count; i-- > 0;)
+        {
+            uint32_t hi = i >= blocks ? this->limbs[i - blocks] : 0;
+            uint32_t lo = i >= blocks + 1 ? this->limbs[i - blocks - 1] : 0;
+            this->limbs[i] = bits == 0 ? hi : (hi << bits | lo >> (32 - bits));
+        }
+        return *this;
+    }
+
+    // Arithmetic for Signed, so negative values round towards minus infinity.
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator>>=(int rhs)
+    {
+        if (rhs < 0) return *this <<= -rhs;
+        uint32_t fill = this->is_negative() ? 0xffffffffu : 0;
+        size_t blocks = static_cast<size_t>(rhs) / 32;
+        unsigned bits = static_cast<unsigned>(rhs) % 32;
+        for (size_t i = 0; i < limb_count; ++i)
+        {
+            uint32_t lo = blocks < limb_count - i ? this->limbs[i + blocks] : fill;
+            uint32_t hi = blocks + 1 < limb_count - i ? this->limbs[i + blocks + 1] : fill;
+            this->limbs[i] = bits == 0 ? lo : (lo >> bits | hi << (32 - bits));
+        }
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer operator+() const
+    {
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer operator-() const
+    {
+        fixed_big_integer r = *this;
+        r.negate();
+        return r;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer operator~() const
+    {
+        fixed_big_integer r;
+        for (size_t i = 0; i < limb_count; ++i) r.limbs[i] = ~this->limbs[i];
+        return r;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator++()
+    {
+        for (size_t i = 0; i < limb_count && ++this->limbs[i] == 0; ++i)
+        {
+        }
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer operator++(int)
+    {
+        fixed_big_integer r = *this;
+        ++*this;
+        return r;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer& operator--()
+    {
+        for (size_t i = 0; i < limb_count && this->limbs[i]-- == 0; ++i)
+        {
+        }
+        return *this;
+    }
+
+    BIGINT_CONSTEXPR14 fixed_big_integer operator--(int)
+    {
+        fixed_big_integer r = *this;
+        --*this;
+        return r;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator+(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a += b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator-(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a -= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator*(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a *= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator/(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a /= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator%(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a %= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator&(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a &= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator|(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a |= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator^(fixed_big_integer a, fixed_big_integer const& b)
+    {
+        return a ^= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator<<(fixed_big_integer a, int b)
+    {
+        return a <<= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 fixed_big_integer operator>>(fixed_big_integer a, int b)
+    {
+        return a >>= b;
+    }
+
+    friend BIGINT_CONSTEXPR14 bool operator==(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return compare(a, b) == 0;
+    }
+
+    friend BIGINT_CONSTEXPR14 bool operator!=(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return compare(a, b) != 0;
+    }
+
+    friend BIGINT_CONSTEXPR14 bool operator<(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return compare(a, b) < 0;
+    }
+
+    friend BIGINT_CONSTEXPR14 bool operator>(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return compare(a, b) > 0;
+    }
+
+    friend BIGINT_CONSTEXPR14 bool operator<=(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return compare(a, b) <= 0;
+    }
+
+    friend BIGINT_CONSTEXPR14 bool operator>=(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        return compare(a, b) >= 0;
+    }
+
+    // Throws std::invalid_argument unless base is in [2, 36].
+    friend std::string to_string(fixed_big_integer const& a, int base = 10)
+    {
+        if (base < 2 || base > 36) throw std::invalid_argument("to_string: base must be in [2, 36]");
+        bool neg = a.is_negative();
+        fixed_big_integer abs = neg ? -a : a;
+        std::string res;
+        if (neg) res.push_back('-');
+        string_output out(res);
+        limbs_to_radix(abs.limbs, size_of(abs.limbs), static_cast<unsigned>(base), false, out);
+        return res;
+    }
+
+    // Through big_integer, so the stream flags are honored the same way.
+    friend std::ostream& operator<<(std::ostream& s, fixed_big_integer const& a)
+    {
+        return s << a.to_big_integer();
+    }
+
+    friend std::istream& operator>>(std::istream& s, fixed_big_integer& a)
+    {
+        big_integer value;
+        s >> value;
+        a = fixed_big_integer(value);
+        return s;
+    }
+
+private:
+    uint32_t limbs[limb_count];
+
+    template <size_t... I>
+    constexpr fixed_big_integer(uint64_t x, bool neg, fixed_index_list<I...>) : limbs{limb_of(x, neg, I)...}
+    {
+    }
+
+    static constexpr uint32_t limb_of(uint64_t x, bool neg, size_t i)
+    {
+        return i < 2 ? static_cast<uint32_t>(x >> (32 * i)) : (neg ? 0xffffffffu : 0);
+    }
+
+    // The limb count without leading zeros.
+    static BIGINT_CONSTEXPR14 size_t size_of(uint32_t const* a)
+    {
+        size_t n = limb_count;
+        while (n > 0 && a[n - 1] == 0) --n;
+        return n;
+    }
+
+    BIGINT_CONSTEXPR14 void negate()
+    {
+        uint64_t carry = 1;
+        fixed_unroll<limb_count>::run(negate_step{this->limbs, &carry});
+    }
+
+    struct add_step
+    {
+        uint32_t* r;
+        uint32_t const* b;
+        uint64_t* carry;
+
+        BIGINT_CONSTEXPR14 void operator()(size_t i) const
+        {
+            *carry += static_cast<uint64_t>(r[i]) + b[i];
+            r[i] = static_cast<uint32_t>(*carry);
+            *carry >>= 32;
+        }
+    };
+
+    struct sub_step
+    {
+        uint32_t* r;
+        uint32_t const* b;
+        uint64_t* borrow;
+
+        BIGINT_CONSTEXPR14 void operator()(size_t i) const
+        {
+            uint64_t t = static_cast<uint64_t>(r[i]) - b[i] - *borrow;
+            r[i] = static_cast<uint32_t>(t);
+            *borrow = t >> 63;
+        }
+    };
+
+    struct negate_step
+    {
+        uint32_t* r;
+        uint64_t* carry;
+
+        BIGINT_CONSTEXPR14 void operator()(size_t i) const
+        {
+            *carry += static_cast<uint32_t>(~r[i]);
+            r[i] = static_cast<uint32_t>(*carry);
+            *carry >>= 32;
+        }
+    };
+
+    // Adds a[i] * b into r from limb i up, dropping what passes the top.
+    struct mul_row
+    {
+        uint32_t* r;
+        uint32_t const* a;
+        uint32_t const* b;
+
+        BIGINT_CONSTEXPR14 void operator()(size_t i) const
+        {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < limb_count - i; ++j)
+            {
+                carry += static_cast<uint64_t>(a[i]) * b[j] + r[i + j];
+                r[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+        }
+    };
+
+    static BIGINT_CONSTEXPR14 int compare(fixed_big_integer const& a, fixed_big_integer const& b)
+    {
+        if (a.is_negative() != b.is_negative()) return a.is_negative() ? -1 : 1;
+        for (size_t i = limb_count; i-- > 0;)
+        {
+            if (a.limbs[i] != b.limbs[i]) return a.limbs[i] < b.limbs[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // q = u / v and r = u % v as unsigned values, v nonzero, by Knuth's
+    // algorithm D on the stack. q and r may alias u but not v.
+    static BIGINT_CONSTEXPR14 void divide(uint32_t const* u, uint32_t const* v, uint32_t* q, uint32_t* r)
+    {
+        size_t m = size_of(u), n = size_of(v);
+        uint32_t un[limb_count + 1] = {}, vn[limb_count] = {};
+        for (size_t i = 0; i < m; ++i) un[i] = u[i];
+        for (size_t i = 0; i < limb_count; ++i) q[i] = r[i] = 0;
+        if (m < n)
+        {
+            for (size_t i = 0; i < m; ++i) r[i] = un[i];
+            return;
+        }
+        if (limb_count == 1 || n == 1)
+        {
+            uint64_t rem = 0;
+            for (size_t i = m; i-- > 0;)
+            {
+                rem = rem << 32 | un[i];
+                q[i] = static_cast<uint32_t>(rem / v[0]);
+                rem %= v[0];
+            }
+            r[0] = static_cast<uint32_t>(rem);
+            return;
+        }
+
+        // Normalize so the divisor's top bit is set; quotient digit
+        // estimates are then off by at most two.
+        unsigned s = static_cast<unsigned>(__builtin_clz(v[n - 1]));
+        for (size_t i = n; i-- > 0;)
+        {
+            vn[i] = s == 0 ? v[i] : (v[i] << s | (i > 0 ? v[i - 1] >> (32 - s) : 0));
+        }
+        for (size_t i = m + 1; i-- > 0;)
+        {
+            uint32_t lo = i > 0 ? un[i - 1] : 0;
+            un[i] = s == 0 ? un[i] : (un[i] << s | lo >> (32 - s));
+        }
+
+        for (size_t j = m - n + 1; j-- > 0;)
+        {
+            uint64_t num = static_cast<uint64_t>(un[j + n]) << 32 | un[j + n - 1];
+            uint64_t qhat = num / vn[n - 1], rhat = num % vn[n - 1];
+            while (qhat > 0xffffffffu || qhat * vn[n - 2] > (rhat << 32 | un[j + n - 2]))
+            {
+                --qhat;
+                rhat += vn[n - 1];
+                if (rhat > 0xffffffffu) break;
+            }
+
+            int64_t borrow = 0, t = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint64_t p = qhat * vn[i];
+                t = static_cast<int64_t>(un[i + j]) - borrow - static_cast<int64_t>(p & 0xffffffffu);
+                un[i + j] = static_cast<uint32_t>(t);
+                borrow = static_cast<int64_t>(p >> 32) - (t >> 32);
+            }
+            t = static_cast<int64_t>(un[j + n]) - borrow;
+            un[j + n] = static_cast<uint32_t>(t);
+            q[j] = static_cast<uint32_t>(qhat);
+
+            // The estimate was one too large: add the divisor back.
+            if (t < 0)
+            {
+                --q[j];
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    carry += static_cast<uint64_t>(un[i + j]) + vn[i];
+                    un[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                un[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            r[i] = s == 0 ? un[i] : (un[i] >> s | un[i + 1] << (32 - s));
+        }
+    }
+};
+
+template <size_t Bits, bool Signed>
+const size_t fixed_big_integer<Bits, Signed>::limb_count;
+
+#endif //BIGINT_FIXED_BIG_INTEGER_H
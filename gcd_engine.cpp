@@ -0,0 +1,485 @@
+#include "gcd_engine.h"
+#include "div_engine.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include <algorithm>
+
+gcd_thresholds &gcd_tuning()
+{
+    static gcd_thresholds tuning = {200, 700};
+    return tuning;
+}
+
+namespace
+{
+typedef std::vector<uint32_t> limb_vector;
+
+// A row of a cofactor matrix M, which maps the reduced pair back to the pair
+// it was reduced from: (a; b) = M (alpha; beta). Every step is either
+// alpha -= q * beta, M <- M * [[1, q], [0, 1]], or beta -= q * alpha,
+// M <- M * [[1, 0], [q, 1]], so the entries stay nonnegative and det M = 1.
+// Entries are kept normalized; an empty vector is zero. spare keeps its
+// capacity between updates.
+struct cofactor_row
+{
+    limb_vector c0, c1, spare;
+};
+
+struct cofactor_matrix
+{
+    cofactor_row row[2];
+
+    cofactor_matrix()
+    {
+        this->row[0].c0.assign(1, 1);
+        this->row[1].c1.assign(1, 1);
+    }
+};
+
+// The product of a run of steps small enough for single-limb entries.
+struct lehmer_matrix
+{
+    uint32_t u00, u01, u10, u11;
+};
+
+// The pair being reduced. a and b have room for n limbs each and n is the
+// longer one's length, so at most one of them has a zero top limb. A step
+// writes its results to ta and tb and swaps them in.
+struct gcd_state
+{
+    limb_vector own, q, r;
+    uint32_t *a, *b, *ta, *tb;
+    size_t n;
+
+    gcd_state(uint32_t *a, uint32_t *b, size_t n) : own(2 * n), a(a), b(b), n(n)
+    {
+        this->ta = this->own.data();
+        this->tb = this->ta + n;
+        this->trim();
+    }
+
+    // Copy of the limbs of from at and above p.
+    gcd_state(gcd_state const &from, size_t p) : own(4 * (from.n - p)), n(from.n - p)
+    {
+        this->a = this->own.data();
+        this->b = this->a + this->n;
+        this->ta = this->b + this->n;
+        this->tb = this->ta + this->n;
+        std::copy(from.a + p, from.a + from.n, this->a);
+        std::copy(from.b + p, from.b + from.n, this->b);
+    }
+
+    void trim()
+    {
+        while (this->n > 0 && this->a[this->n - 1] == 0 && this->b[this->n - 1] == 0) --this->n;
+    }
+};
+}
+
+static size_t normalized(uint32_t const *a, size_t n)
+{
+    return limbs_normalized_size(a, n);
+}
+
+static void normalize(limb_vector &x)
+{
+    x.resize(normalized(x.data(), x.size()));
+}
+
+static limb_vector product(uint32_t const *x, size_t xn, uint32_t const *y, size_t yn)
+{
+    limb_vector res;
+    if (xn == 0 || yn == 0) return res;
+    res.resize(xn + yn);
+    mul_limbs(&res[0], x, xn, y, yn);
+    normalize(res);
+    return res;
+}
+
+static limb_vector product(limb_vector const &x, limb_vector const &y)
+{
+    return product(x.data(), x.size(), y.data(), y.size());
+}
+
+// x += y * z
+static void add_product(limb_vector &x, limb_vector const &y, limb_vector const &z)
+{
+    limb_vector p = product(y, z);
+    if (x.size() < p.size()) x.swap(p);
+    x.push_back(0);
+    limbs_add(&x[0], &x[0], x.size(), p.data(), p.size());
+    normalize(x);
+}
+
+// r = x * u + y * v. r may be x.
+static void combine(limb_vector &r, limb_vector const &x, uint32_t u, limb_vector const &y, uint32_t v)
+{
+    size_t xn = x.size();
+    size_t yn = y.size();
+    size_t n = std::max(xn, yn) + 2;
+    r.resize(n);
+    std::fill(r.begin() + xn, r.end(), 0);
+    if (xn != 0) r[xn] = limbs_mul_1(&r[0], x.data(), xn, u);
+    if (yn != 0)
+    {
+        uint32_t carry = limbs_addmul_1(&r[0], y.data(), yn, v);
+        limbs_add_1(&r[yn], &r[yn], n - yn, carry);
+    }
+    normalize(r);
+}
+
+static void mul_row(cofactor_row &row, lehmer_matrix const &u)
+{
+    combine(row.spare, row.c0, u.u01, row.c1, u.u11);
+    combine(row.c0, row.c0, u.u00, row.c1, u.u10);
+    row.c1.swap(row.spare);
+}
+
+static void mul_row(cofactor_row &row, cofactor_matrix const &m)
+{
+    limb_vector c0 = product(row.c0, m.row[0].c0);
+    add_product(c0, row.c1, m.row[1].c0);
+    limb_vector c1 = product(row.c0, m.row[0].c1);
+    add_product(c1, row.c1, m.row[1].c1);
+    row.c0.swap(c0);
+    row.c1.swap(c1);
+}
+
+// The step that reduced a (which == 0) or b (which == 1) by q.
+static void mul_row(cofactor_row &row, limb_vector const &q, int which)
+{
+    if (which == 0)
+    {
+        add_product(row.c1, q, row.c0);
+    }
+    else
+    {
+        add_product(row.c0, q, row.c1);
+    }
+}
+
+// The low 64 bits of a >> p, for a of n limbs.
+static uint64_t bits_at(uint32_t const *a, size_t n, size_t p)
+{
+    size_t i = p / LIMB_BITS;
+    unsigned shift = p % LIMB_BITS;
+    uint64_t lo = a[i];
+    if (i + 1 < n) lo |= static_cast<uint64_t>(a[i + 1]) << LIMB_BITS;
+    if (shift == 0) return lo;
+    uint64_t hi = i + 2 < n ? a[i + 2] : 0;
+    return lo >> shift | hi << (2 * LIMB_BITS - shift);
+}
+
+// Steps on ah and bh, the pair's values shifted down by some p. The true
+// alpha lies in (ah - u01, ah + u11) and beta in (bh - u10, bh + u00), in
+// units of 2^p, so a quotient taken between the ends of those intervals
+// never exceeds the true one and the reduced pair stays nonnegative; taking
+// it against floor + the lower end keeps the pair at least floor * 2^p. With
+// exact set (p = 0) the intervals are points. Stops before an entry would
+// outgrow a limb.
+static lehmer_matrix lehmer(uint64_t ah, uint64_t bh, bool exact, uint64_t floor)
+{
+    uint64_t e = exact ? 0 : 1;
+    lehmer_matrix u = {1, 0, 0, 1};
+    for (;;)
+    {
+        if (ah >= bh)
+        {
+            uint64_t low = e * u.u01 + floor;
+            if (ah < low || bh + e * u.u00 == 0) break;
+            uint64_t q = (ah - low) / (bh + e * u.u00);
+            if (q == 0 || q > LIMB_MAX) break;
+            uint64_t u01 = u.u01 + q * u.u00;
+            uint64_t u11 = u.u11 + q * u.u10;
+            if (u01 > LIMB_MAX || u11 > LIMB_MAX) break;
+            ah -= q * bh;
+            u.u01 = static_cast<uint32_t>(u01);
+            u.u11 = static_cast<uint32_t>(u11);
+        }
+        else
+        {
+            uint64_t low = e * u.u10 + floor;
+            if (bh < low || ah + e * u.u11 == 0) break;
+            uint64_t q = (bh - low) / (ah + e * u.u11);
+            if (q == 0 || q > LIMB_MAX) break;
+            uint64_t u00 = u.u00 + q * u.u01;
+            uint64_t u10 = u.u10 + q * u.u11;
+            if (u00 > LIMB_MAX || u10 > LIMB_MAX) break;
+            bh -= q * ah;
+            u.u00 = static_cast<uint32_t>(u00);
+            u.u10 = static_cast<uint32_t>(u10);
+        }
+    }
+    return u;
+}
+
+static bool is_identity(lehmer_matrix const &u)
+{
+    return u.u01 == 0 && u.u10 == 0;
+}
+
+// Runs Lehmer steps on the top 63 bits of the pair, keeping both values
+// above s limbs when s > 0, and unless none could be taken writes the
+// reduced pair to ta and tb. Returns the steps' product.
+static lehmer_matrix lehmer_step(gcd_state &st, size_t s)
+{
+    lehmer_matrix u = {1, 0, 0, 1};
+    size_t n = st.n;
+    uint32_t top = std::max(st.a[n - 1], st.b[n - 1]);
+    size_t bits = n * LIMB_BITS - static_cast<size_t>(__builtin_clz(top));
+    size_t p = bits > 63 ? bits - 63 : 0;
+    uint64_t floor = 0;
+    if (s > 0)
+    {
+        size_t floor_bits = s * LIMB_BITS > p ? s * LIMB_BITS - p : 0;
+        if (floor_bits >= 63) return u;
+        floor = static_cast<uint64_t>(1) << floor_bits;
+    }
+    u = lehmer(bits_at(st.a, n, p), bits_at(st.b, n, p), p == 0, floor);
+    if (!is_identity(u))
+    {
+        // alpha = u11 a - u01 b, beta = u00 b - u10 a; both fit in n limbs,
+        // so the carries out of the top cancel.
+        limbs_mul_1(st.ta, st.a, n, u.u11);
+        limbs_submul_1(st.ta, st.b, n, u.u01);
+        limbs_mul_1(st.tb, st.b, n, u.u00);
+        limbs_submul_1(st.tb, st.a, n, u.u10);
+    }
+    return u;
+}
+
+// Replaces the larger value by its remainder modulo the smaller, leaving the
+// quotient in st.q. With s > 0 both values must keep more than s limbs, so
+// the quotient is lowered by one when the remainder would not, and nothing
+// happens when that leaves no quotient. Returns 0 when a was reduced, 1 when
+// b was and -1 when neither.
+static int div_step(gcd_state &st, size_t s)
+{
+    size_t an = normalized(st.a, st.n);
+    size_t bn = normalized(st.b, st.n);
+    int which = limbs_cmp(st.a, an, st.b, bn) >= 0 ? 0 : 1;
+    uint32_t *x = which == 0 ? st.a : st.b;
+    uint32_t const *y = which == 0 ? st.b : st.a;
+    size_t xn = which == 0 ? an : bn;
+    size_t yn = which == 0 ? bn : an;
+    if (yn == 0 || (s > 0 && yn <= s)) return -1;
+
+    st.q.assign(xn - yn + 1, 0);
+    st.r.assign(yn + 1, 0);
+    div_limbs(&st.q[0], &st.r[0], x, xn, y, yn);
+    size_t rn = normalized(&st.r[0], yn);
+    if (s > 0 && rn <= s)
+    {
+        if (st.q[0] == 1 && normalized(&st.q[0], st.q.size()) == 1) return -1;
+        limbs_sub_1(&st.q[0], &st.q[0], st.q.size(), 1);
+        st.r[yn] = limbs_add(&st.r[0], &st.r[0], yn, y, yn);
+        rn = normalized(&st.r[0], yn + 1);
+    }
+    std::fill(x, x + st.n, 0);
+    std::copy(st.r.begin(), st.r.begin() + rn, x);
+    normalize(st.q);
+    return which;
+}
+
+// One reduction of the pair that keeps both values above s limbs (any
+// reduction when s is 0), applied to the given cofactor rows as well: a run
+// of Lehmer steps when one applies, a division otherwise. Returns false when
+// no reduction is possible.
+static bool reduce_step(gcd_state &st, size_t s, cofactor_row *rows, size_t count)
+{
+    if (st.n == 0) return false;
+    lehmer_matrix u = lehmer_step(st, s);
+    if (!is_identity(u))
+    {
+        std::swap(st.a, st.ta);
+        std::swap(st.b, st.tb);
+        for (size_t i = 0; i < count; ++i) mul_row(rows[i], u);
+        st.trim();
+        return true;
+    }
+
+    int which = div_step(st, s);
+    if (which < 0) return false;
+    for (size_t i = 0; i < count; ++i) mul_row(rows[i], st.q, which);
+    st.trim();
+    return true;
+}
+
+// r = top * B^p + x - y, or false when that is negative.
+static bool shifted_difference(limb_vector &r, uint32_t const *top, size_t topn, size_t p, limb_vector const &x, limb_vector const &y)
+{
+    size_t n = std::max(topn + p, std::max(x.size(), y.size())) + 1;
+    r.assign(n, 0);
+    std::copy(top, top + topn, &r[p]);
+    limbs_add(&r[0], &r[0], n, x.data(), x.size());
+    if (limbs_sub(&r[0], &r[0], n, y.data(), y.size()) != 0) return false;
+    normalize(r);
+    return true;
+}
+
+// Applies m, found by reducing the pair's limbs at and above p into top, to
+// the whole pair: (a; b) <- M^-1 (a; b) = (m11 a - m01 b; m00 b - m10 a),
+// where the top limbs' share is already in top and only the low p limbs
+// are multiplied out. Leaves the pair alone and returns false if a result
+// would be negative or, with s > 0, not above s limbs; a matrix from the top
+// limbs normally passes, but the checks keep any matrix safe.
+static bool apply_top(gcd_state &st, gcd_state const &top, size_t p, cofactor_matrix const &m, size_t s)
+{
+    size_t an = normalized(st.a, p);
+    size_t bn = normalized(st.b, p);
+    cofactor_row const &r0 = m.row[0];
+    cofactor_row const &r1 = m.row[1];
+    limb_vector alpha, beta;
+    if (!shifted_difference(alpha, top.a, top.n, p, product(r1.c1.data(), r1.c1.size(), st.a, an),
+                            product(r0.c1.data(), r0.c1.size(), st.b, bn)) ||
+        !shifted_difference(beta, top.b, top.n, p, product(r0.c0.data(), r0.c0.size(), st.b, bn),
+                            product(r1.c0.data(), r1.c0.size(), st.a, an)))
+    {
+        return false;
+    }
+    if (s > 0 && (alpha.size() <= s || beta.size() <= s)) return false;
+
+    // Both results are nonnegative, so neither exceeds the value it replaces.
+    std::fill(st.a, st.a + st.n, 0);
+    std::fill(st.b, st.b + st.n, 0);
+    std::copy(alpha.begin(), alpha.end(), st.a);
+    std::copy(beta.begin(), beta.end(), st.b);
+    st.trim();
+    return true;
+}
+
+// Half-gcd: reduces an n-limb pair as far as it goes while both values keep
+// more than s = n / 2 + 1 limbs, accumulating the steps in m (the identity
+// on entry). Above the threshold the first half of the work is a recursive
+// call on the top half, which takes the pair to about 3n / 4 limbs, and the
+// second is one on the top limbs that are left (Moller's arrangement of
+// Schonhage's algorithm). Returns false when nothing was reduced.
+static bool hgcd(gcd_state &st, cofactor_matrix &m)
+{
+    size_t n = st.n;
+    size_t s = n / 2 + 1;
+    if (normalized(st.a, n) <= s || normalized(st.b, n) <= s) return false;
+
+    bool reduced = false;
+    if (n >= gcd_tuning().hgcd)
+    {
+        gcd_state top(st, n / 2);
+        if (hgcd(top, m) && apply_top(st, top, n / 2, m, s))
+        {
+            reduced = true;
+        }
+        else
+        {
+            m = cofactor_matrix();
+        }
+
+        while (st.n > 3 * n / 4 + 1)
+        {
+            if (!reduce_step(st, s, m.row, 2)) return reduced;
+            reduced = true;
+        }
+
+        if (st.n > s + 2)
+        {
+            cofactor_matrix m2;
+            size_t p = 2 * s - st.n + 1;
+            gcd_state rest(st, p);
+            if (hgcd(rest, m2) && apply_top(st, rest, p, m2, s))
+            {
+                mul_row(m.row[0], m2);
+                mul_row(m.row[1], m2);
+                reduced = true;
+            }
+        }
+    }
+
+    while (reduce_step(st, s, m.row, 2)) reduced = true;
+    return reduced;
+}
+
+// Reduces the pair until one value is zero, which leaves the gcd in the
+// other. Long pairs lose about a sixth of their length per half-gcd on
+// their top third; binary_tail stops at two limbs for gcd_2.
+static void reduce_to_gcd(gcd_state &st, cofactor_row *rows, size_t count, bool binary_tail)
+{
+    gcd_thresholds const &tuning = gcd_tuning();
+    while (st.n >= tuning.gcd)
+    {
+        cofactor_matrix m;
+        size_t p = 2 * st.n / 3;
+        gcd_state top(st, p);
+        if (hgcd(top, m) && apply_top(st, top, p, m, 0))
+        {
+            for (size_t i = 0; i < count; ++i) mul_row(rows[i], m);
+            continue;
+        }
+        int which = div_step(st, 0);
+        if (which < 0) return;
+        for (size_t i = 0; i < count; ++i) mul_row(rows[i], st.q, which);
+        st.trim();
+    }
+
+    while ((!binary_tail || st.n > 2) && reduce_step(st, 0, rows, count))
+    {
+    }
+}
+
+// Binary gcd on single words.
+static uint64_t gcd_2(uint64_t a, uint64_t b)
+{
+    if (a == 0) return b;
+    if (b == 0) return a;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0)
+    {
+        b >>= __builtin_ctzll(b);
+        if (a > b) std::swap(a, b);
+        b -= a;
+    }
+    return a << shift;
+}
+
+static uint64_t value_2(uint32_t const *a, size_t n)
+{
+    uint64_t res = n > 0 ? a[0] : 0;
+    if (n > 1) res |= static_cast<uint64_t>(a[1]) << LIMB_BITS;
+    return res;
+}
+
+size_t gcd_limbs(uint32_t *g, uint32_t *a, uint32_t *b, size_t n)
+{
+    gcd_state st(a, b, n);
+    reduce_to_gcd(st, 0, 0, true);
+    std::fill(g, g + n, 0);
+    if (st.n <= 2)
+    {
+        uint64_t res = gcd_2(value_2(st.a, st.n), value_2(st.b, st.n));
+        if (res == 0) return 0;
+        g[0] = static_cast<uint32_t>(res);
+        if (res > LIMB_MAX) g[1] = static_cast<uint32_t>(res >> LIMB_BITS);
+        return res > LIMB_MAX ? 2 : 1;
+    }
+
+    uint32_t const *res = normalized(st.b, st.n) == 0 ? st.a : st.b;
+    std::copy(res, res + st.n, g);
+    return normalized(g, st.n);
+}
+
+size_t gcdext_limbs(uint32_t *g, std::vector<uint32_t> &x, bool &x_neg, uint32_t *a, uint32_t *b, size_t n)
+{
+    // Only the second row of M is needed: the gcd ends up as alpha =
+    // m11 a - m01 b or as beta = m00 b - m10 a.
+    gcd_state st(a, b, n);
+    cofactor_row row;
+    row.c1.assign(1, 1);
+    reduce_to_gcd(st, &row, 1, false);
+
+    bool in_a = normalized(st.b, st.n) == 0;
+    uint32_t const *res = in_a ? st.a : st.b;
+    std::fill(g, g + n, 0);
+    std::copy(res, res + st.n, g);
+    x.swap(in_a ? row.c1 : row.c0);
+    x_neg = !in_a && !x.empty();
+    return normalized(g, st.n);
+}
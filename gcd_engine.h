@@ -0,0 +1,28 @@
+#ifndef BIGINT_GCD_ENGINE_H
+#define BIGINT_GCD_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Lengths (in limbs) from which the gcd works through half-gcd matrices:
+// hgcd recursion inside a half-gcd call, and the gcd reducing its operands
+// with half-gcd calls at all. Below them Lehmer steps do the work.
+// bench/gcd.cpp times the gcd on both sides of the crossover.
+struct gcd_thresholds
+{
+    size_t hgcd;
+    size_t gcd;
+};
+
+gcd_thresholds &gcd_tuning();
+
+// g = gcd(a, b). a and b have n limbs each (the shorter one zero-padded)
+// and are clobbered; g has n limbs. Returns the length of g.
+size_t gcd_limbs(uint32_t *g, uint32_t *a, uint32_t *b, size_t n);
+
+// gcd_limbs, also setting x to the cofactor of a with g = x * a + y * b
+// for some y, |x| <= b / g, and x_neg to its sign.
+size_t gcdext_limbs(uint32_t *g, std::vector<uint32_t> &x, bool &x_neg, uint32_t *a, uint32_t *b, size_t n);
+
+#endif //BIGINT_GCD_ENGINE_H
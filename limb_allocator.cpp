@@ -0,0 +1,266 @@
+#include "limb_allocator.h"
+#include <new>
+
+static const size_t POOL_MIN_SHIFT = 5;
+static const size_t POOL_MAX_SHIFT = 16;
+static const size_t POOL_CLASSES = POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1;
+// Blocks kept per size class; the rest go back to the heap.
+static const size_t POOL_CLASS_LIMIT = 64;
+static const size_t ARENA_ALIGN = 16;
+
+static thread_local limb_alloc_stats stats;
+static thread_local limb_allocator *current;
+
+limb_alloc_stats &limb_allocation_stats()
+{
+    return stats;
+}
+
+static void *heap_allocate(size_t bytes)
+{
+    ++stats.heap_allocations;
+    return ::operator new(bytes);
+}
+
+static void heap_free(void *p)
+{
+    ++stats.heap_frees;
+    ::operator delete(p);
+}
+
+namespace
+{
+    struct heap_allocator : limb_allocator
+    {
+        void *allocate(size_t bytes)
+        {
+            return heap_allocate(bytes);
+        }
+
+        void deallocate(void *p, size_t)
+        {
+            heap_free(p);
+        }
+    };
+
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    struct pool_lists
+    {
+        free_block *head[POOL_CLASSES];
+        size_t count[POOL_CLASSES];
+
+        pool_lists();
+        ~pool_lists();
+    };
+
+    enum pool_state_t { POOL_UNUSED, POOL_LIVE, POOL_DESTROYED };
+
+    // Trivially destructible, so it stays readable while other thread_local
+    // objects (possibly holding pooled values) are being destroyed.
+    thread_local pool_state_t pool_state;
+
+    pool_lists::pool_lists()
+    {
+        for (size_t i = 0; i < POOL_CLASSES; ++i)
+        {
+            head[i] = 0;
+            count[i] = 0;
+        }
+        pool_state = POOL_LIVE;
+    }
+
+    pool_lists::~pool_lists()
+    {
+        pool_state = POOL_DESTROYED;
+        for (size_t i = 0; i < POOL_CLASSES; ++i)
+        {
+            while (head[i] != 0)
+            {
+                free_block *next = head[i]->next;
+                heap_free(head[i]);
+                head[i] = next;
+            }
+        }
+    }
+
+    thread_local pool_lists pool;
+
+    // Index of the smallest class holding bytes.
+    size_t pool_class(size_t bytes)
+    {
+        size_t shift = POOL_MIN_SHIFT;
+        while ((size_t(1) << shift) < bytes) ++shift;
+        return shift - POOL_MIN_SHIFT;
+    }
+
+    struct pool_allocator : limb_allocator
+    {
+        void *allocate(size_t bytes)
+        {
+            if (bytes > LIMB_POOL_MAX_BYTES || pool_state == POOL_DESTROYED) return heap_allocate(bytes);
+            size_t c = pool_class(bytes);
+            pool_lists &lists = pool;
+            if (lists.head[c] != 0)
+            {
+                free_block *b = lists.head[c];
+                lists.head[c] = b->next;
+                --lists.count[c];
+                ++stats.pool_reuses;
+                return b;
+            }
+            return heap_allocate(size_t(1) << (c + POOL_MIN_SHIFT));
+        }
+
+        void deallocate(void *p, size_t bytes)
+        {
+            if (bytes > LIMB_POOL_MAX_BYTES || pool_state == POOL_DESTROYED)
+            {
+                heap_free(p);
+                return;
+            }
+            size_t c = pool_class(bytes);
+            pool_lists &lists = pool;
+            if (lists.count[c] == POOL_CLASS_LIMIT)
+            {
+                heap_free(p);
+                return;
+            }
+            free_block *b = static_cast<free_block *>(p);
+            b->next = lists.head[c];
+            lists.head[c] = b;
+            ++lists.count[c];
+        }
+    };
+
+    heap_allocator heap_instance;
+    pool_allocator pool_instance;
+}
+
+limb_allocator &heap_limb_allocator()
+{
+    return heap_instance;
+}
+
+limb_allocator &pool_limb_allocator()
+{
+    return pool_instance;
+}
+
+limb_allocator &current_limb_allocator()
+{
+    return current != 0 ? *current : pool_instance;
+}
+
+limb_allocator *set_limb_allocator(limb_allocator *a)
+{
+    limb_allocator *prev = current;
+    current = a;
+    return prev;
+}
+
+static size_t align_up(size_t bytes)
+{
+    return (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+// The memory behind one big_integer_arena. It outlives the scope while any
+// of its blocks is still held and frees itself with the last of them.
+struct big_integer_arena::blocks final : limb_allocator
+{
+    struct chunk
+    {
+        chunk *next;
+        size_t size;
+    };
+
+    chunk *chunks;
+    char *top;
+    char *end;
+    size_t chunk_bytes;
+    size_t live;
+    bool closed;
+    limb_allocator *enclosing;
+
+    blocks(size_t chunk_bytes, limb_allocator *enclosing)
+        : chunks(0), top(0), end(0), chunk_bytes(chunk_bytes), live(0), closed(false), enclosing(enclosing)
+    {
+    }
+
+    void *allocate(size_t bytes);
+    void deallocate(void *p, size_t bytes);
+
+    limb_allocator *outer()
+    {
+        return enclosing;
+    }
+
+    void close();
+    void release();
+};
+
+static limb_allocator *first_unscoped(limb_allocator *a)
+{
+    while (limb_allocator *o = a->outer()) a = o;
+    return a;
+}
+
+big_integer_arena::big_integer_arena(size_t chunk_bytes)
+    : state(new blocks(chunk_bytes, first_unscoped(&current_limb_allocator()))), previous(set_limb_allocator(state))
+{
+}
+
+big_integer_arena::~big_integer_arena()
+{
+    set_limb_allocator(previous);
+    state->close();
+}
+
+void *big_integer_arena::blocks::allocate(size_t bytes)
+{
+    bytes = align_up(bytes);
+    ++stats.arena_allocations;
+    ++live;
+    if (static_cast<size_t>(end - top) < bytes)
+    {
+        size_t header = align_up(sizeof(chunk));
+        size_t size = bytes > chunk_bytes ? bytes : chunk_bytes;
+        chunk *c = static_cast<chunk *>(heap_allocate(header + size));
+        c->next = chunks;
+        c->size = size;
+        chunks = c;
+        top = reinterpret_cast<char *>(c) + header;
+        end = top + size;
+    }
+    void *res = top;
+    top += bytes;
+    return res;
+}
+
+// Only the most recent allocation can be handed back early; everything
+// else waits for the scope to end.
+void big_integer_arena::blocks::deallocate(void *p, size_t bytes)
+{
+    if (static_cast<char *>(p) + align_up(bytes) == top) top = static_cast<char *>(p);
+    if (--live == 0 && closed) release();
+}
+
+void big_integer_arena::blocks::close()
+{
+    closed = true;
+    if (live == 0) release();
+}
+
+void big_integer_arena::blocks::release()
+{
+    while (chunks != 0)
+    {
+        chunk *next = chunks->next;
+        heap_free(chunks);
+        chunks = next;
+    }
+    delete this;
+}
@@ -0,0 +1,85 @@
+#ifndef BIGINT_LIMB_ALLOCATOR_H
+#define BIGINT_LIMB_ALLOCATOR_H
+
+#include <stddef.h>
+
+// Source of the heap blocks behind vector_with_opt. Every block remembers
+// the allocator it came from and is handed back to it, so values made
+// under different allocators can be mixed freely.
+struct limb_allocator
+{
+    virtual void *allocate(size_t bytes) = 0;
+    virtual void deallocate(void *p, size_t bytes) = 0;
+
+    // For an allocator whose blocks belong to a scope, the allocator that
+    // copies and moves of them go to, itself never scoped; null for the
+    // others, whose blocks last as long as they are referenced.
+    virtual limb_allocator *outer()
+    {
+        return 0;
+    }
+
+protected:
+    ~limb_allocator() {}
+};
+
+// Plain ::operator new / ::operator delete.
+limb_allocator &heap_limb_allocator();
+
+// Per-thread free lists of power-of-two size classes up to
+// LIMB_POOL_MAX_BYTES; larger blocks go straight to the heap. A block may
+// be freed on a different thread from the one that allocated it.
+limb_allocator &pool_limb_allocator();
+
+const size_t LIMB_POOL_MAX_BYTES = 64 * 1024;
+
+// The allocator new blocks come from on this thread: the pool unless
+// set_limb_allocator or a big_integer_arena says otherwise.
+limb_allocator &current_limb_allocator();
+
+// Returns the previous allocator; null restores the default.
+limb_allocator *set_limb_allocator(limb_allocator *a);
+
+// Counts for the calling thread, never reset by the library.
+struct limb_alloc_stats
+{
+    size_t heap_allocations;
+    size_t heap_frees;
+    size_t pool_reuses;
+    size_t arena_allocations;
+};
+
+limb_alloc_stats &limb_allocation_stats();
+
+// Bump allocator that becomes the thread's current allocator for its
+// lifetime, so the temporaries made inside it cost a pointer bump each and
+// are released together:
+//
+//     {
+//         big_integer_arena scope;
+//         ... temporaries ...
+//     }
+//
+// Arena limbs do not travel with values: copying or moving a value puts
+// its limbs on the first allocator outside the scope that is not an arena,
+// and a value that already had a block grows from that block's allocator.
+// A value that starts inline and grows in place inside the scope keeps its
+// arena limbs; the arena's memory then lives on until the last such block
+// is released.
+class big_integer_arena
+{
+public:
+    explicit big_integer_arena(size_t chunk_bytes = 64 * 1024);
+    ~big_integer_arena();
+
+private:
+    struct blocks;
+
+    big_integer_arena(big_integer_arena const &);
+    big_integer_arena &operator=(big_integer_arena const &);
+
+    blocks *state;
+    limb_allocator *previous;
+};
+
+#endif //BIGINT_LIMB_ALLOCATOR_H
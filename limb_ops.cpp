@@ -0,0 +1,261 @@
+#include "limb_ops.h"
+#include "limb_simd.h"
+#include <cstring>
+#include <algorithm>
+
+// Two adjacent limbs as one 64-bit word, so add and sub run their carry
+// chain over half as many steps.
+static inline uint64_t load_pair(uint32_t const *p)
+{
+    return p[0] | static_cast<uint64_t>(p[1]) << LIMB_BITS;
+}
+
+static inline void store_pair(uint32_t *p, uint64_t x)
+{
+    p[0] = static_cast<uint32_t>(x);
+    p[1] = static_cast<uint32_t>(x >> LIMB_BITS);
+}
+
+uint32_t limbs_add(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    uint64_t carry = 0;
+    size_t i = 0;
+    if (limb_simd != 0 && bn >= limb_simd->width)
+    {
+        i = bn - bn % limb_simd->width;
+        carry = limb_simd->add_n(r, a, b, i, 0);
+    }
+    for (; i + 2 <= bn; i += 2)
+    {
+        uint64_t s;
+        bool c1 = __builtin_add_overflow(load_pair(a + i), load_pair(b + i), &s);
+        bool c2 = __builtin_add_overflow(s, carry, &s);
+        store_pair(r + i, s);
+        carry = c1 | c2;
+    }
+    for (; i < bn; ++i)
+    {
+        uint64_t t = static_cast<uint64_t>(a[i]) + b[i] + carry;
+        r[i] = static_cast<uint32_t>(t);
+        carry = t >> LIMB_BITS;
+    }
+    return limbs_add_1(r + i, a + i, an - i, static_cast<uint32_t>(carry));
+}
+
+// Stops once the carry dies out: in place that leaves the rest alone, so
+// adding a small number costs O(1) amortised.
+uint32_t limbs_add_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x)
+{
+    uint64_t carry = x;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (carry == 0)
+        {
+            if (r != a) std::copy(a + i, a + n, r + i);
+            return 0;
+        }
+        uint64_t t = static_cast<uint64_t>(a[i]) + carry;
+        r[i] = static_cast<uint32_t>(t);
+        carry = t >> LIMB_BITS;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t limbs_sub(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    uint64_t borrow = 0;
+    size_t i = 0;
+    if (limb_simd != 0 && bn >= limb_simd->width)
+    {
+        i = bn - bn % limb_simd->width;
+        borrow = limb_simd->sub_n(r, a, b, i, 0);
+    }
+    for (; i + 2 <= bn; i += 2)
+    {
+        uint64_t d;
+        bool b1 = __builtin_sub_overflow(load_pair(a + i), load_pair(b + i), &d);
+        bool b2 = __builtin_sub_overflow(d, borrow, &d);
+        store_pair(r + i, d);
+        borrow = b1 | b2;
+    }
+    for (; i < bn; ++i)
+    {
+        uint64_t t = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<uint32_t>(t);
+        borrow = t >> 63;
+    }
+    return limbs_sub_1(r + i, a + i, an - i, static_cast<uint32_t>(borrow));
+}
+
+// Stops once the borrow dies out, as limbs_add_1 does.
+uint32_t limbs_sub_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x)
+{
+    uint64_t borrow = x;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (borrow == 0)
+        {
+            if (r != a) std::copy(a + i, a + n, r + i);
+            return 0;
+        }
+        uint64_t t = static_cast<uint64_t>(a[i]) - borrow;
+        r[i] = static_cast<uint32_t>(t);
+        borrow = t >> 63;
+    }
+    return static_cast<uint32_t>(borrow);
+}
+
+uint32_t limbs_mul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t t = static_cast<uint64_t>(a[i]) * x + carry;
+        r[i] = static_cast<uint32_t>(t);
+        carry = t >> LIMB_BITS;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t limbs_addmul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t t = static_cast<uint64_t>(a[i]) * x + r[i] + carry;
+        r[i] = static_cast<uint32_t>(t);
+        carry = t >> LIMB_BITS;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t limbs_submul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x)
+{
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t t = static_cast<uint64_t>(a[i]) * x + carry;
+        uint32_t right = static_cast<uint32_t>(t);
+        carry = (t >> LIMB_BITS) + (r[i] < right);
+        r[i] -= right;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t limbs_divrem_1(uint32_t *q, uint32_t const *a, size_t n, uint32_t x)
+{
+    uint64_t rem = 0;
+    for (size_t i = n; i > 0; --i)
+    {
+        uint64_t t = rem << LIMB_BITS | a[i - 1];
+        q[i - 1] = static_cast<uint32_t>(t / x);
+        rem = t % x;
+    }
+    return static_cast<uint32_t>(rem);
+}
+
+void limbs_and_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)
+{
+    size_t i = 0;
+    if (limb_simd != 0 && n >= limb_simd->width)
+    {
+        i = n - n % limb_simd->width;
+        limb_simd->and_n(r, a, b, i);
+    }
+    for (; i < n; ++i) r[i] = a[i] & b[i];
+}
+
+void limbs_ior_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)
+{
+    size_t i = 0;
+    if (limb_simd != 0 && n >= limb_simd->width)
+    {
+        i = n - n % limb_simd->width;
+        limb_simd->ior_n(r, a, b, i);
+    }
+    for (; i < n; ++i) r[i] = a[i] | b[i];
+}
+
+void limbs_xor_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)
+{
+    size_t i = 0;
+    if (limb_simd != 0 && n >= limb_simd->width)
+    {
+        i = n - n % limb_simd->width;
+        limb_simd->xor_n(r, a, b, i);
+    }
+    for (; i < n; ++i) r[i] = a[i] ^ b[i];
+}
+
+uint32_t limbs_lshift(uint32_t *r, uint32_t const *a, size_t n, unsigned bits)
+{
+    if (n == 0) return 0;
+    if (bits == 0)
+    {
+        std::memmove(r, a, n * sizeof(uint32_t));
+        return 0;
+    }
+    uint32_t out = a[n - 1] >> (32 - bits);
+    size_t top = n;
+    if (limb_simd != 0 && n - 1 >= limb_simd->width)
+    {
+        size_t k = (n - 1) - (n - 1) % limb_simd->width;
+        top = n - k;
+        limb_simd->lshift_n(r, a, top, k, bits);
+    }
+    for (size_t i = top - 1; i > 0; --i)
+    {
+        r[i] = (a[i] << bits) | (a[i - 1] >> (32 - bits));
+    }
+    r[0] = a[0] << bits;
+    return out;
+}
+
+uint32_t limbs_rshift(uint32_t *r, uint32_t const *a, size_t n, unsigned bits)
+{
+    if (n == 0) return 0;
+    if (bits == 0)
+    {
+        std::memmove(r, a, n * sizeof(uint32_t));
+        return 0;
+    }
+    uint32_t out = a[0] << (32 - bits);
+    size_t i = 0;
+    if (limb_simd != 0 && n - 1 >= limb_simd->width)
+    {
+        i = (n - 1) - (n - 1) % limb_simd->width;
+        limb_simd->rshift_n(r, a, i, bits);
+    }
+    for (; i + 1 < n; ++i)
+    {
+        r[i] = (a[i] >> bits) | (a[i + 1] << (32 - bits));
+    }
+    r[n - 1] = a[n - 1] >> bits;
+    return out;
+}
+
+int limbs_cmp(uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    an = limbs_normalized_size(a, an);
+    bn = limbs_normalized_size(b, bn);
+    if (an != bn) return an > bn ? 1 : -1;
+    size_t i = an;
+    if (limb_simd != 0 && an >= limb_simd->width)
+    {
+        size_t k = an - an % limb_simd->width;
+        size_t d = limb_simd->diff_n(a, b, an - k, k);
+        if (d != 0) return a[d - 1] > b[d - 1] ? 1 : -1;
+        i = an - k;
+    }
+    for (; i > 0; --i)
+    {
+        if (a[i - 1] != b[i - 1]) return a[i - 1] > b[i - 1] ? 1 : -1;
+    }
+    return 0;
+}
+
+size_t limbs_normalized_size(uint32_t const *a, size_t n)
+{
+    while (n > 0 && a[n - 1] == 0) --n;
+    return n;
+}
@@ -0,0 +1,47 @@
+#ifndef BIGINT_LIMB_OPS_H
+#define BIGINT_LIMB_OPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Kernels over raw little-endian limb spans. Every limb is a digit in base
+// 2^LIMB_BITS, so carries and quotients by the base are shifts and masks.
+// The linear kernels hand long spans to the vector code in limb_simd.h.
+const unsigned LIMB_BITS = 32;
+const uint32_t LIMB_MAX = 0xffffffffu;
+
+// r = a + b, an >= bn, r has an limbs and may alias a or b. Returns the carry.
+uint32_t limbs_add(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+// r = a + x, r has n limbs and may alias a. Returns the carry.
+uint32_t limbs_add_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+// r = a - b, an >= bn, r has an limbs and may alias a or b. Returns the borrow.
+uint32_t limbs_sub(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+// r = a - x, r has n limbs and may alias a. Returns the borrow.
+uint32_t limbs_sub_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+
+// r = a * x, r has n limbs and may alias a. Returns the high limb.
+uint32_t limbs_mul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+// r += a * x over n limbs. Returns the high limb.
+uint32_t limbs_addmul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+// r -= a * x over n limbs. Returns the limb still to be subtracted above r.
+uint32_t limbs_submul_1(uint32_t *r, uint32_t const *a, size_t n, uint32_t x);
+// q = a / x, q has n limbs and may alias a. Returns the remainder.
+uint32_t limbs_divrem_1(uint32_t *q, uint32_t const *a, size_t n, uint32_t x);
+
+// r = a & b, a | b, a ^ b over n limbs. r may alias a or b.
+void limbs_and_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+void limbs_ior_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+void limbs_xor_n(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+
+// r = a << bits (bits < 32) over n limbs. r may be at or above a. Returns
+// the bits shifted out of the top limb.
+uint32_t limbs_lshift(uint32_t *r, uint32_t const *a, size_t n, unsigned bits);
+// r = a >> bits (bits < 32) over n limbs. r may be at or below a. Returns
+// the bits shifted out of the bottom limb, in the high end of the result.
+uint32_t limbs_rshift(uint32_t *r, uint32_t const *a, size_t n, unsigned bits);
+
+int limbs_cmp(uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+// Length of a without its leading zero limbs (0 for a zero value).
+size_t limbs_normalized_size(uint32_t const *a, size_t n);
+
+#endif //BIGINT_LIMB_OPS_H
@@ -0,0 +1,332 @@
+#include "limb_simd.h"
+
+limb_simd_kernels const *limb_simd = 0;
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// GCC 12's AVX-512 headers trip -Wmaybe-uninitialized on their own
+// _mm512_undefined_epi32().
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+#define BIGINT_AVX2 __attribute__((target("avx2")))
+#define BIGINT_AVX512 __attribute__((target("avx512f")))
+
+// Carry-lookahead: every lane is summed independently, then the lanes that
+// generate a carry (g) and the all-ones lanes that pass one on (p) are
+// resolved with one scalar addition, (g << 1) + p + carry_in, whose bits
+// that differ from p are the lanes that receive a carry. Borrows work the
+// same way with all-zero lanes propagating.
+
+BIGINT_AVX2
+static __m256i lane_mask_avx2(unsigned mask)
+{
+    __m256i const bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bits), bits);
+}
+
+BIGINT_AVX2
+static unsigned movemask_avx2(__m256i x)
+{
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(x)));
+}
+
+BIGINT_AVX2
+static uint32_t add_n_avx2(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t carry)
+{
+    __m256i const sign = _mm256_set1_epi32(INT32_MIN);
+    __m256i const ones = _mm256_set1_epi32(-1);
+    unsigned c = carry;
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+        __m256i s = _mm256_add_epi32(x, y);
+        unsigned g = movemask_avx2(_mm256_cmpgt_epi32(_mm256_xor_si256(x, sign), _mm256_xor_si256(s, sign)));
+        unsigned p = movemask_avx2(_mm256_cmpeq_epi32(s, ones));
+        unsigned t = (g << 1) + p + c;
+        c = t >> 8;
+        s = _mm256_sub_epi32(s, lane_mask_avx2(t ^ p));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), s);
+    }
+    return c;
+}
+
+BIGINT_AVX2
+static uint32_t sub_n_avx2(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t borrow)
+{
+    __m256i const sign = _mm256_set1_epi32(INT32_MIN);
+    __m256i const zero = _mm256_setzero_si256();
+    unsigned c = borrow;
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+        __m256i d = _mm256_sub_epi32(x, y);
+        unsigned g = movemask_avx2(_mm256_cmpgt_epi32(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign)));
+        unsigned p = movemask_avx2(_mm256_cmpeq_epi32(d, zero));
+        unsigned t = (g << 1) + p + c;
+        c = t >> 8;
+        d = _mm256_add_epi32(d, lane_mask_avx2(t ^ p));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), d);
+    }
+    return c;
+}
+
+#define BIGINT_BITWISE_AVX2(name, op)                                                  \
+    BIGINT_AVX2                                                                        \
+    static void name(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)      \
+    {                                                                                  \
+        for (size_t i = 0; i < n; i += 8)                                              \
+        {                                                                              \
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));  \
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));  \
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), op(x, y));         \
+        }                                                                              \
+    }
+
+BIGINT_BITWISE_AVX2(and_n_avx2, _mm256_and_si256)
+BIGINT_BITWISE_AVX2(ior_n_avx2, _mm256_or_si256)
+BIGINT_BITWISE_AVX2(xor_n_avx2, _mm256_xor_si256)
+
+BIGINT_AVX2
+static void lshift_n_avx2(uint32_t *r, uint32_t const *a, size_t lo, size_t n, unsigned bits)
+{
+    __m128i const left = _mm_cvtsi32_si128(static_cast<int>(bits));
+    __m128i const right = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+    for (size_t i = lo + n; i > lo;)
+    {
+        i -= 8;
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i - 1));
+        __m256i res = _mm256_or_si256(_mm256_sll_epi32(hi, left), _mm256_srl_epi32(low, right));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), res);
+    }
+}
+
+BIGINT_AVX2
+static void rshift_n_avx2(uint32_t *r, uint32_t const *a, size_t n, unsigned bits)
+{
+    __m128i const right = _mm_cvtsi32_si128(static_cast<int>(bits));
+    __m128i const left = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i + 1));
+        __m256i res = _mm256_or_si256(_mm256_srl_epi32(low, right), _mm256_sll_epi32(hi, left));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), res);
+    }
+}
+
+BIGINT_AVX2
+static size_t diff_n_avx2(uint32_t const *a, uint32_t const *b, size_t lo, size_t n)
+{
+    for (size_t i = lo + n; i > lo;)
+    {
+        i -= 8;
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+        unsigned ne = ~movemask_avx2(_mm256_cmpeq_epi32(x, y)) & 0xffu;
+        if (ne != 0) return i + 32 - static_cast<size_t>(__builtin_clz(ne));
+    }
+    return 0;
+}
+
+BIGINT_AVX512
+static uint32_t add_n_avx512(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t carry)
+{
+    __m512i const ones = _mm512_set1_epi32(-1);
+    __m512i const one = _mm512_set1_epi32(1);
+    unsigned c = carry;
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __m512i s = _mm512_add_epi32(x, y);
+        unsigned g = _mm512_cmplt_epu32_mask(s, x);
+        unsigned p = _mm512_cmpeq_epi32_mask(s, ones);
+        unsigned t = (g << 1) + p + c;
+        c = t >> 16;
+        s = _mm512_mask_add_epi32(s, static_cast<__mmask16>(t ^ p), s, one);
+        _mm512_storeu_si512(r + i, s);
+    }
+    return c;
+}
+
+BIGINT_AVX512
+static uint32_t sub_n_avx512(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t borrow)
+{
+    __m512i const zero = _mm512_setzero_si512();
+    __m512i const one = _mm512_set1_epi32(1);
+    unsigned c = borrow;
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __m512i d = _mm512_sub_epi32(x, y);
+        unsigned g = _mm512_cmplt_epu32_mask(x, y);
+        unsigned p = _mm512_cmpeq_epi32_mask(d, zero);
+        unsigned t = (g << 1) + p + c;
+        c = t >> 16;
+        d = _mm512_mask_sub_epi32(d, static_cast<__mmask16>(t ^ p), d, one);
+        _mm512_storeu_si512(r + i, d);
+    }
+    return c;
+}
+
+#define BIGINT_BITWISE_AVX512(name, op)                                                \
+    BIGINT_AVX512                                                                      \
+    static void name(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n)      \
+    {                                                                                  \
+        for (size_t i = 0; i < n; i += 16)                                             \
+        {                                                                              \
+            _mm512_storeu_si512(r + i, op(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))); \
+        }                                                                              \
+    }
+
+BIGINT_BITWISE_AVX512(and_n_avx512, _mm512_and_si512)
+BIGINT_BITWISE_AVX512(ior_n_avx512, _mm512_or_si512)
+BIGINT_BITWISE_AVX512(xor_n_avx512, _mm512_xor_si512)
+
+BIGINT_AVX512
+static void lshift_n_avx512(uint32_t *r, uint32_t const *a, size_t lo, size_t n, unsigned bits)
+{
+    __m128i const left = _mm_cvtsi32_si128(static_cast<int>(bits));
+    __m128i const right = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+    for (size_t i = lo + n; i > lo;)
+    {
+        i -= 16;
+        __m512i hi = _mm512_loadu_si512(a + i);
+        __m512i low = _mm512_loadu_si512(a + i - 1);
+        _mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_sll_epi32(hi, left), _mm512_srl_epi32(low, right)));
+    }
+}
+
+BIGINT_AVX512
+static void rshift_n_avx512(uint32_t *r, uint32_t const *a, size_t n, unsigned bits)
+{
+    __m128i const right = _mm_cvtsi32_si128(static_cast<int>(bits));
+    __m128i const left = _mm_cvtsi32_si128(static_cast<int>(32 - bits));
+    for (size_t i = 0; i < n; i += 16)
+    {
+        __m512i low = _mm512_loadu_si512(a + i);
+        __m512i hi = _mm512_loadu_si512(a + i + 1);
+        _mm512_storeu_si512(r + i, _mm512_or_si512(_mm512_srl_epi32(low, right), _mm512_sll_epi32(hi, left)));
+    }
+}
+
+BIGINT_AVX512
+static size_t diff_n_avx512(uint32_t const *a, uint32_t const *b, size_t lo, size_t n)
+{
+    for (size_t i = lo + n; i > lo;)
+    {
+        i -= 16;
+        unsigned ne = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        if (ne != 0) return i + 32 - static_cast<size_t>(__builtin_clz(ne));
+    }
+    return 0;
+}
+
+// The product of two limbs plus two more fits a 64-bit lane exactly, so each
+// lane carries on its own with no lookahead.
+
+BIGINT_AVX2
+static void mul_lanes_avx2(uint64_t *r, uint64_t const *a, size_t an, uint64_t const *b, size_t bn)
+{
+    __m256i const low = _mm256_set1_epi64x(0xffffffff);
+    for (size_t i = 0; i < an + bn; ++i)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + 4 * i), _mm256_setzero_si256());
+    }
+    for (size_t j = 0; j < bn; ++j)
+    {
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + 4 * j));
+        __m256i carry = _mm256_setzero_si256();
+        for (size_t i = 0; i < an; ++i)
+        {
+            __m256i *ri = reinterpret_cast<__m256i *>(r + 4 * (i + j));
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + 4 * i));
+            __m256i t = _mm256_add_epi64(_mm256_mul_epu32(x, y), _mm256_add_epi64(_mm256_loadu_si256(ri), carry));
+            _mm256_storeu_si256(ri, _mm256_and_si256(t, low));
+            carry = _mm256_srli_epi64(t, 32);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + 4 * (an + j)), carry);
+    }
+}
+
+BIGINT_AVX512
+static void mul_lanes_avx512(uint64_t *r, uint64_t const *a, size_t an, uint64_t const *b, size_t bn)
+{
+    __m512i const low = _mm512_set1_epi64(0xffffffff);
+    for (size_t i = 0; i < an + bn; ++i)
+    {
+        _mm512_storeu_si512(r + 8 * i, _mm512_setzero_si512());
+    }
+    for (size_t j = 0; j < bn; ++j)
+    {
+        __m512i y = _mm512_loadu_si512(b + 8 * j);
+        __m512i carry = _mm512_setzero_si512();
+        for (size_t i = 0; i < an; ++i)
+        {
+            uint64_t *ri = r + 8 * (i + j);
+            __m512i t = _mm512_add_epi64(_mm512_mul_epu32(_mm512_loadu_si512(a + 8 * i), y),
+                                         _mm512_add_epi64(_mm512_loadu_si512(ri), carry));
+            _mm512_storeu_si512(ri, _mm512_and_si512(t, low));
+            carry = _mm512_srli_epi64(t, 32);
+        }
+        _mm512_storeu_si512(r + 8 * (an + j), carry);
+    }
+}
+
+static limb_simd_kernels const avx2_kernels =
+{
+    8, add_n_avx2, sub_n_avx2, and_n_avx2, ior_n_avx2, xor_n_avx2, lshift_n_avx2, rshift_n_avx2, diff_n_avx2,
+    4, mul_lanes_avx2
+};
+
+static limb_simd_kernels const avx512_kernels =
+{
+    16, add_n_avx512, sub_n_avx512, and_n_avx512, ior_n_avx512, xor_n_avx512,
+    lshift_n_avx512, rshift_n_avx512, diff_n_avx512, 8, mul_lanes_avx512
+};
+
+limb_simd_level limb_simd_supported()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return LIMB_SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return LIMB_SIMD_AVX2;
+    return LIMB_SIMD_SCALAR;
+}
+
+limb_simd_level set_limb_simd_level(limb_simd_level level)
+{
+    limb_simd_level supported = limb_simd_supported();
+    if (level > supported) level = supported;
+    limb_simd = level == LIMB_SIMD_AVX512 ? &avx512_kernels : level == LIMB_SIMD_AVX2 ? &avx2_kernels : 0;
+    return level;
+}
+
+#else
+
+limb_simd_level limb_simd_supported()
+{
+    return LIMB_SIMD_SCALAR;
+}
+
+limb_simd_level set_limb_simd_level(limb_simd_level)
+{
+    return LIMB_SIMD_SCALAR;
+}
+
+#endif
+
+limb_simd_level limb_simd_active()
+{
+    if (limb_simd == 0) return LIMB_SIMD_SCALAR;
+    return limb_simd->width == 16 ? LIMB_SIMD_AVX512 : LIMB_SIMD_AVX2;
+}
+
+// Kernels called before this runs (from other static initializers) use
+// the scalar code, which is always correct.
+static limb_simd_level const startup_level = set_limb_simd_level(LIMB_SIMD_AVX512);
@@ -0,0 +1,63 @@
+#ifndef BIGINT_LIMB_SIMD_H
+#define BIGINT_LIMB_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Vector versions of the linear limb kernels, picked once at startup from
+// what the CPU supports. The functions in limb_ops.h hand the bulk of a
+// span to them and finish the last few limbs themselves.
+
+enum limb_simd_level
+{
+    LIMB_SIMD_SCALAR,
+    LIMB_SIMD_AVX2,
+    LIMB_SIMD_AVX512
+};
+
+// Every n passed in is a multiple of width.
+struct limb_simd_kernels
+{
+    size_t width;
+
+    // r = a + b + carry with a carry-lookahead over each vector; r may alias
+    // a or b. Returns the carry out.
+    uint32_t (*add_n)(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t carry);
+    uint32_t (*sub_n)(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n, uint32_t borrow);
+
+    void (*and_n)(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+    void (*ior_n)(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+    void (*xor_n)(uint32_t *r, uint32_t const *a, uint32_t const *b, size_t n);
+
+    // r[i] = a[i] << bits | a[i - 1] >> (32 - bits) for i in [lo, lo + n),
+    // lo >= 1, from the top down. 0 < bits < 32.
+    void (*lshift_n)(uint32_t *r, uint32_t const *a, size_t lo, size_t n, unsigned bits);
+    // r[i] = a[i] >> bits | a[i + 1] << (32 - bits) for i in [0, n), from the
+    // bottom up; a[n] must exist.
+    void (*rshift_n)(uint32_t *r, uint32_t const *a, size_t n, unsigned bits);
+
+    // Index past the highest limb in [lo, lo + n) where a and b differ,
+    // scanning down; 0 when they are equal there.
+    size_t (*diff_n)(uint32_t const *a, uint32_t const *b, size_t lo, size_t n);
+
+    // Number of independent products mul_lanes computes side by side.
+    size_t lanes;
+    // Schoolbook products of lanes pairs at once, one pair per 64-bit lane:
+    // row i of a (lanes values from a + i * lanes) holds limb i of every left
+    // operand, zero-extended, and likewise for b and r. r has an + bn rows
+    // and must not overlap a or b.
+    void (*mul_lanes)(uint64_t *r, uint64_t const *a, size_t an, uint64_t const *b, size_t bn);
+};
+
+// Null while the scalar kernels are in use.
+extern limb_simd_kernels const *limb_simd;
+
+limb_simd_level limb_simd_supported();
+limb_simd_level limb_simd_active();
+
+// Switches to the given level, capped at what the CPU supports, and returns
+// the level in effect. Meant for tests and benchmarks: no kernel may be
+// running on another thread meanwhile.
+limb_simd_level set_limb_simd_level(limb_simd_level level);
+
+#endif //BIGINT_LIMB_SIMD_H
@@ -0,0 +1,268 @@
+#include "modular_context.h"
+#include "big_integer_expr.h"
+#include "div_engine.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include <algorithm>
+
+// -a^-1 mod B for odd a: each Newton step doubles the correct low bits.
+static uint32_t negated_inverse(uint32_t a)
+{
+    uint32_t inv = a;
+    for (int i = 0; i < 4; ++i) inv *= 2 - a * inv;
+    return 0u - inv;
+}
+
+modular_context::modular_context(big_integer const &modulus)
+    : m_value(modulus < 0 ? -modulus : modulus), m_inv(0)
+{
+    expr_term mt = big_integer_expr_access::term(this->m_value);
+    this->m.assign(mt.limbs, mt.limbs + mt.size);
+    this->k = mt.size;
+
+    // One division of B^2k by m gives both R^2 mod m and the Barrett
+    // reciprocal.
+    std::vector<uint32_t> u(2 * this->k + 1, 0), q(this->k + 2), rem(this->k);
+    u[2 * this->k] = 1;
+    div_limbs(&q[0], &rem[0], &u[0], u.size(), &this->m[0], this->k);
+
+    if (this->montgomery())
+    {
+        this->m_inv = negated_inverse(this->m[0]);
+        this->r2 = rem;
+    }
+    else
+    {
+        this->mu.assign(q.begin(), q.begin() + limbs_normalized_size(&q[0], q.size()));
+    }
+    this->one = this->residue(1);
+}
+
+big_integer const &modular_context::modulus() const
+{
+    return this->m_value;
+}
+
+bool modular_context::montgomery() const
+{
+    return (this->m[0] & 1) != 0;
+}
+
+size_t modular_context::scratch_limbs() const
+{
+    // The product, then for Barrett q1 * mu and q3 * m.
+    size_t n = 2 * this->k;
+    if (!this->montgomery()) n += (this->k + 1 + this->mu.size()) + (this->mu.size() + this->k);
+    return n;
+}
+
+void modular_context::reduce(uint32_t *r, uint32_t *t, uint32_t *scratch) const
+{
+    size_t k = this->k;
+    uint32_t const *m = &this->m[0];
+    if (this->montgomery())
+    {
+        // REDC: clear the low limb k times by adding multiples of m, keeping
+        // the carry out of the top apart so t stays 2k limbs.
+        uint32_t hi = 0;
+        for (size_t i = 0; i < k; ++i)
+        {
+            uint32_t c = limbs_addmul_1(t + i, m, k, t[i] * this->m_inv);
+            uint64_t s = static_cast<uint64_t>(t[i + k]) + c + hi;
+            t[i + k] = static_cast<uint32_t>(s);
+            hi = static_cast<uint32_t>(s >> LIMB_BITS);
+        }
+        // t / B^k is below 2m.
+        if (hi != 0 || limbs_cmp(t + k, k, m, k) >= 0)
+        {
+            limbs_sub(r, t + k, k, m, k);
+        }
+        else
+        {
+            std::copy(t + k, t + 2 * k, r);
+        }
+        return;
+    }
+
+    // Barrett: q3 = floor(floor(t / B^(k-1)) * mu / B^(k+1)) is at most two
+    // below t / m, so t - q3 * m taken mod B^(k+1) needs at most two more
+    // subtractions.
+    size_t mun = this->mu.size();
+    uint32_t *q2 = scratch;
+    uint32_t *p = q2 + (k + 1 + mun);
+    mul_limbs(q2, t + k - 1, k + 1, &this->mu[0], mun);
+    mul_limbs(p, q2 + k + 1, mun, m, k);
+    limbs_sub(t, t, k + 1, p, k + 1);
+    while (limbs_cmp(t, k + 1, m, k) >= 0)
+    {
+        limbs_sub(t, t, k + 1, m, k);
+    }
+    std::copy(t, t + k, r);
+}
+
+void modular_context::mul_into(uint32_t *r, uint32_t const *a, uint32_t const *b, uint32_t *scratch) const
+{
+    mul_limbs(scratch, a, this->k, b, this->k);
+    this->reduce(r, scratch, scratch + 2 * this->k);
+}
+
+mod_residue modular_context::residue(big_integer const &a) const
+{
+    size_t k = this->k;
+    expr_term t = big_integer_expr_access::term(a);
+    mod_residue res;
+    res.limbs.assign(k, 0);
+    if (limbs_cmp(t.limbs, t.size, &this->m[0], k) < 0)
+    {
+        std::copy(t.limbs, t.limbs + t.size, res.limbs.begin());
+    }
+    else
+    {
+        std::vector<uint32_t> q(t.size - k + 1);
+        div_limbs(&q[0], &res.limbs[0], t.limbs, t.size, &this->m[0], k);
+    }
+    if (t.neg && limbs_normalized_size(&res.limbs[0], k) != 0)
+    {
+        limbs_sub(&res.limbs[0], &this->m[0], k, &res.limbs[0], k);
+    }
+
+    if (this->montgomery())
+    {
+        std::vector<uint32_t> scratch(this->scratch_limbs());
+        this->mul_into(&res.limbs[0], &res.limbs[0], &this->r2[0], &scratch[0]);
+    }
+    return res;
+}
+
+big_integer modular_context::value(mod_residue const &a) const
+{
+    std::vector<uint32_t> limbs(a.limbs);
+    if (this->montgomery())
+    {
+        std::vector<uint32_t> t(2 * this->k, 0);
+        std::copy(a.limbs.begin(), a.limbs.end(), t.begin());
+        this->reduce(&limbs[0], &t[0], 0);
+    }
+    big_integer res;
+    big_integer_expr_access::assign(res, &limbs[0], limbs_normalized_size(&limbs[0], this->k), false);
+    return res;
+}
+
+mod_residue modular_context::add_mod(mod_residue const &a, mod_residue const &b) const
+{
+    size_t k = this->k;
+    mod_residue res;
+    res.limbs.resize(k);
+    uint32_t carry = limbs_add(&res.limbs[0], &a.limbs[0], k, &b.limbs[0], k);
+    if (carry != 0 || limbs_cmp(&res.limbs[0], k, &this->m[0], k) >= 0)
+    {
+        limbs_sub(&res.limbs[0], &res.limbs[0], k, &this->m[0], k);
+    }
+    return res;
+}
+
+mod_residue modular_context::sub_mod(mod_residue const &a, mod_residue const &b) const
+{
+    size_t k = this->k;
+    mod_residue res;
+    res.limbs.resize(k);
+    if (limbs_sub(&res.limbs[0], &a.limbs[0], k, &b.limbs[0], k) != 0)
+    {
+        limbs_add(&res.limbs[0], &res.limbs[0], k, &this->m[0], k);
+    }
+    return res;
+}
+
+mod_residue modular_context::mul_mod(mod_residue const &a, mod_residue const &b) const
+{
+    std::vector<uint32_t> scratch(this->scratch_limbs());
+    mod_residue res;
+    res.limbs.resize(this->k);
+    this->mul_into(&res.limbs[0], &a.limbs[0], &b.limbs[0], &scratch[0]);
+    return res;
+}
+
+mod_residue modular_context::sqr_mod(mod_residue const &a) const
+{
+    return this->mul_mod(a, a);
+}
+
+// Window width for an exponent of the given bit length, trading the table
+// of odd powers against the multiplications it saves.
+static unsigned window_bits(size_t bits)
+{
+    if (bits > 671) return 6;
+    if (bits > 239) return 5;
+    if (bits > 79) return 4;
+    if (bits > 23) return 3;
+    if (bits > 7) return 2;
+    return 1;
+}
+
+mod_residue modular_context::pow_mod(mod_residue const &a, big_integer const &e) const
+{
+    size_t k = this->k;
+    expr_term et = big_integer_expr_access::term(e);
+    size_t bits = et.size == 0 ? 0 : et.size * LIMB_BITS - static_cast<size_t>(__builtin_clz(et.limbs[et.size - 1]));
+    mod_residue res = this->one;
+    if (bits == 0) return res;
+
+    // table[j] = a^(2j + 1) for the odd window values.
+    unsigned w = window_bits(bits);
+    size_t entries = static_cast<size_t>(1) << (w - 1);
+    std::vector<uint32_t> scratch(this->scratch_limbs());
+    std::vector<uint32_t> table(entries * k), a2(k);
+    std::copy(a.limbs.begin(), a.limbs.end(), table.begin());
+    if (entries > 1) this->mul_into(&a2[0], &a.limbs[0], &a.limbs[0], &scratch[0]);
+    for (size_t j = 1; j < entries; ++j)
+    {
+        this->mul_into(&table[j * k], &table[(j - 1) * k], &a2[0], &scratch[0]);
+    }
+
+    uint32_t *r = &res.limbs[0];
+    bool started = false;
+    size_t i = bits;
+    while (i > 0)
+    {
+        size_t top = i - 1;
+        if (((et.limbs[top / LIMB_BITS] >> (top % LIMB_BITS)) & 1) == 0)
+        {
+            if (started) this->mul_into(r, r, r, &scratch[0]);
+            i = top;
+            continue;
+        }
+
+        // The longest window of at most w bits from top that ends in a one.
+        size_t low = top + 1 >= w ? top + 1 - w : 0;
+        while (((et.limbs[low / LIMB_BITS] >> (low % LIMB_BITS)) & 1) == 0) ++low;
+        size_t value = 0;
+        for (size_t b = top + 1; b > low; --b)
+        {
+            value = value << 1 | ((et.limbs[(b - 1) / LIMB_BITS] >> ((b - 1) % LIMB_BITS)) & 1);
+        }
+
+        uint32_t const *entry = &table[(value >> 1) * k];
+        if (started)
+        {
+            for (size_t s = low; s <= top; ++s) this->mul_into(r, r, r, &scratch[0]);
+            this->mul_into(r, r, entry, &scratch[0]);
+        }
+        else
+        {
+            std::copy(entry, entry + k, r);
+            started = true;
+        }
+        i = low;
+    }
+    return res;
+}
+
+big_integer modular_context::mul_mod(big_integer const &a, big_integer const &b) const
+{
+    return this->value(this->mul_mod(this->residue(a), this->residue(b)));
+}
+
+big_integer modular_context::pow_mod(big_integer const &a, big_integer const &e) const
+{
+    return this->value(this->pow_mod(this->residue(a), e));
+}
@@ -0,0 +1,66 @@
+#ifndef BIGINT_MODULAR_CONTEXT_H
+#define BIGINT_MODULAR_CONTEXT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "big_integer.h"
+
+// A value modulo the modulus of the modular_context that made it, kept in
+// that context's internal form. Only meaningful with that context.
+class mod_residue
+{
+    friend class modular_context;
+    std::vector<uint32_t> limbs;
+};
+
+// Arithmetic modulo a fixed modulus without a division per operation.
+// Odd moduli use Montgomery reduction with residues in Montgomery form;
+// even moduli use Barrett reduction with a precomputed reciprocal. All
+// members are const, so one context can be shared between threads.
+class modular_context
+{
+public:
+    // modulus must be nonzero; its sign is ignored.
+    explicit modular_context(big_integer const &modulus);
+
+    big_integer const &modulus() const;
+    bool montgomery() const;
+
+    // a mod m for any a, negative ones included.
+    mod_residue residue(big_integer const &a) const;
+    // The residue's value in [0, m).
+    big_integer value(mod_residue const &a) const;
+
+    mod_residue add_mod(mod_residue const &a, mod_residue const &b) const;
+    mod_residue sub_mod(mod_residue const &a, mod_residue const &b) const;
+    mod_residue mul_mod(mod_residue const &a, mod_residue const &b) const;
+    mod_residue sqr_mod(mod_residue const &a) const;
+    // a^e for e >= 0 by left-to-right sliding windows over e.
+    mod_residue pow_mod(mod_residue const &a, big_integer const &e) const;
+
+    // The same on plain values, with results in [0, m).
+    big_integer mul_mod(big_integer const &a, big_integer const &b) const;
+    big_integer pow_mod(big_integer const &a, big_integer const &e) const;
+
+private:
+    size_t scratch_limbs() const;
+    // r = a * b, reduced; a, b and r have k limbs and r may alias them.
+    void mul_into(uint32_t *r, uint32_t const *a, uint32_t const *b, uint32_t *scratch) const;
+    // r = t * R^-1 mod m (Montgomery) or t mod m (Barrett) for t below m^2;
+    // t has 2k limbs and is clobbered.
+    void reduce(uint32_t *r, uint32_t *t, uint32_t *scratch) const;
+
+    big_integer m_value;
+    std::vector<uint32_t> m;
+    size_t k;
+    // -m^-1 mod B, Montgomery only.
+    uint32_t m_inv;
+    // floor(B^2k / m), Barrett only.
+    std::vector<uint32_t> mu;
+    // R^2 mod m with R = B^k, Montgomery only.
+    std::vector<uint32_t> r2;
+    mod_residue one;
+};
+
+#endif //BIGINT_MODULAR_CONTEXT_H
@@ -0,0 +1,424 @@
+#include "mul_engine.h"
+#include "limb_ops.h"
+#include "thread_pool.h"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// Below this length a split would not shrink the subproblems.
+static const size_t MIN_SPLIT = 4;
+
+mul_thresholds &mul_tuning()
+{
+    static mul_thresholds tuning = {32, 500, 2500};
+    return tuning;
+}
+
+mul_thresholds &sqr_tuning()
+{
+    static mul_thresholds tuning = {56, 500, 2500};
+    return tuning;
+}
+
+mul_parallel_settings &mul_parallel()
+{
+    static mul_parallel_settings settings = {1, 2000};
+    return settings;
+}
+
+thread_pool *mul_parallel_pool(size_t n)
+{
+    mul_parallel_settings const &settings = mul_parallel();
+    if (settings.threads <= 1 || n < settings.threshold) return 0;
+
+    static std::mutex pool_lock;
+    static std::unique_ptr<thread_pool> pool;
+    std::lock_guard<std::mutex> guard(pool_lock);
+    if (!pool || pool->workers() != settings.threads - 1)
+    {
+        pool.reset(new thread_pool(settings.threads - 1));
+    }
+    return pool.get();
+}
+
+void mul_limbs(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    if (an < bn)
+    {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn == 0)
+    {
+        std::fill(r, r + an, 0);
+        return;
+    }
+    if (a == b && an == bn)
+    {
+        sqr_limbs(r, a, an);
+        return;
+    }
+
+    mul_thresholds const &tuning = mul_tuning();
+    if (bn < tuning.karatsuba || bn < MIN_SPLIT)
+    {
+        mul_schoolbook(r, a, an, b, bn);
+        return;
+    }
+
+    if (bn >= tuning.ntt && an + bn <= NTT_MAX_LIMBS)
+    {
+        mul_ntt(r, a, an, b, bn);
+        return;
+    }
+
+    if (an >= 2 * bn)
+    {
+        // Unbalanced: multiply bn-limb slices of a by b and accumulate.
+        std::fill(r, r + an + bn, 0);
+        thread_pool *pool = mul_parallel_pool(bn);
+        if (pool == 0)
+        {
+            std::vector<uint32_t> tmp(2 * bn);
+            for (size_t off = 0; off < an; off += bn)
+            {
+                size_t len = std::min(bn, an - off);
+                mul_limbs(&tmp[0], a + off, len, b, bn);
+                limbs_add(r + off, r + off, an + bn - off, &tmp[0], len + bn);
+            }
+            return;
+        }
+
+        // In parallel every slice gets its own product buffer.
+        size_t slices = (an + bn - 1) / bn;
+        std::vector<uint32_t> tmp(slices * 2 * bn);
+        std::vector<std::function<void()> > tasks;
+        for (size_t i = 0; i < slices; ++i)
+        {
+            tasks.push_back([&, i]
+            {
+                size_t off = i * bn;
+                mul_limbs(&tmp[2 * off], a + off, std::min(bn, an - off), b, bn);
+            });
+        }
+        run_all(pool, &tasks[0], slices);
+        for (size_t off = 0; off < an; off += bn)
+        {
+            size_t len = std::min(bn, an - off);
+            limbs_add(r + off, r + off, an + bn - off, &tmp[2 * off], len + bn);
+        }
+        return;
+    }
+
+    if (bn < tuning.toom3)
+    {
+        mul_karatsuba(r, a, an, b, bn);
+    }
+    else
+    {
+        mul_toom3(r, a, an, b, bn);
+    }
+}
+
+void mul_schoolbook(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    std::fill(r, r + an, 0);
+    for (size_t j = 0; j < bn; ++j)
+    {
+        r[an + j] = limbs_addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+void sqr_limbs(uint32_t *r, uint32_t const *a, size_t n)
+{
+    if (n == 0) return;
+    mul_thresholds const &tuning = sqr_tuning();
+    if (n < tuning.karatsuba || n < MIN_SPLIT)
+    {
+        sqr_schoolbook(r, a, n);
+    }
+    else if (n >= tuning.ntt && 2 * n <= NTT_MAX_LIMBS)
+    {
+        sqr_ntt(r, a, n);
+    }
+    else if (n < tuning.toom3)
+    {
+        sqr_karatsuba(r, a, n);
+    }
+    else
+    {
+        sqr_toom3(r, a, n);
+    }
+}
+
+void sqr_schoolbook(uint32_t *r, uint32_t const *a, size_t n)
+{
+    // The products a[i] a[j], i < j, row by row.
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+        r[n + i] = limbs_addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+
+    // Double them and add the squares a[i]^2 in one pass. The cross products
+    // sum to less than a^2 / 2, so nothing is shifted out of the top.
+    uint32_t shifted = 0;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t sq = static_cast<uint64_t>(a[i]) * a[i];
+        uint32_t lo = r[2 * i], hi = r[2 * i + 1];
+        uint64_t t = static_cast<uint64_t>(lo << 1 | shifted) + static_cast<uint32_t>(sq) + carry;
+        r[2 * i] = static_cast<uint32_t>(t);
+        t = static_cast<uint64_t>(hi << 1 | lo >> 31) + (sq >> LIMB_BITS) + (t >> LIMB_BITS);
+        r[2 * i + 1] = static_cast<uint32_t>(t);
+        carry = t >> LIMB_BITS;
+        shifted = hi >> 31;
+    }
+}
+
+void sqr_karatsuba(uint32_t *r, uint32_t const *a, size_t n)
+{
+    size_t h = (n + 1) / 2;
+
+    // d = |a0 - a1|, so that 2 a0 a1 = a0^2 + a1^2 - d^2 needs only squares.
+    std::vector<uint32_t> d(h), z1(2 * h), mid(2 * h + 1);
+    if (limbs_cmp(a, h, a + h, n - h) >= 0)
+    {
+        limbs_sub(&d[0], a, h, a + h, n - h);
+    }
+    else
+    {
+        std::copy(a + h, a + n, d.begin());
+        limbs_sub(&d[0], &d[0], h, a, h);
+    }
+
+    // a0^2 goes to r[0, 2h), a1^2 goes to r[2h, 2n).
+    parallel_invoke(mul_parallel_pool(n),
+                    [&] { sqr_limbs(r, a, h); },
+                    [&] { sqr_limbs(r + 2 * h, a + h, n - h); },
+                    [&] { sqr_limbs(&z1[0], &d[0], h); });
+
+    std::copy(r, r + 2 * h, mid.begin());
+    mid[2 * h] = limbs_add(&mid[0], &mid[0], 2 * h, r + 2 * h, 2 * (n - h));
+    limbs_sub(&mid[0], &mid[0], mid.size(), &z1[0], z1.size());
+    size_t mn = limbs_normalized_size(&mid[0], mid.size());
+    limbs_add(r + h, r + h, 2 * n - h, &mid[0], mn);
+}
+
+void mul_karatsuba(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    if (an < bn)
+    {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    size_t h = (an + 1) / 2;
+    size_t rn = an + bn;
+
+    if (bn <= h)
+    {
+        // Only a is long enough to split: r = a0 * b + a1 * b * B^h.
+        std::vector<uint32_t> tmp(rn - h);
+        parallel_invoke(mul_parallel_pool(bn),
+                        [&] { mul_limbs(r, a, h, b, bn); },
+                        [&] { mul_limbs(&tmp[0], a + h, an - h, b, bn); });
+        std::fill(r + h + bn, r + rn, 0);
+        limbs_add(r + h, r + h, rn - h, &tmp[0], rn - h);
+        return;
+    }
+
+    std::vector<uint32_t> sa(h + 1), sb(h + 1), z1(2 * h + 2);
+    sa[h] = limbs_add(&sa[0], a, h, a + h, an - h);
+    sb[h] = limbs_add(&sb[0], b, h, b + h, bn - h);
+
+    // z0 = a0 * b0 goes to r[0, 2h), z2 = a1 * b1 goes to r[2h, rn).
+    parallel_invoke(mul_parallel_pool(bn),
+                    [&] { mul_limbs(r, a, h, b, h); },
+                    [&] { mul_limbs(r + 2 * h, a + h, an - h, b + h, bn - h); },
+                    [&] { mul_limbs(&z1[0], &sa[0], h + 1, &sb[0], h + 1); });
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2, added in at B^h.
+    limbs_sub(&z1[0], &z1[0], z1.size(), r, 2 * h);
+    limbs_sub(&z1[0], &z1[0], z1.size(), r + 2 * h, rn - 2 * h);
+    size_t z1n = limbs_normalized_size(&z1[0], z1.size());
+    limbs_add(r + h, r + h, rn - h, &z1[0], z1n);
+}
+
+namespace
+{
+// Signed magnitude temporaries for the Toom-3 evaluation and interpolation.
+struct signed_limbs
+{
+    std::vector<uint32_t> mag;
+    bool neg;
+
+    signed_limbs() : neg(false) {}
+
+    signed_limbs(uint32_t const *a, size_t n) : mag(a, a + limbs_normalized_size(a, n)), neg(false) {}
+};
+}
+
+static void trim(signed_limbs &x)
+{
+    x.mag.resize(limbs_normalized_size(x.mag.data(), x.mag.size()));
+    if (x.mag.empty()) x.neg = false;
+}
+
+static signed_limbs abs_add(signed_limbs const &x, signed_limbs const &y, bool neg)
+{
+    signed_limbs const &l = x.mag.size() >= y.mag.size() ? x : y;
+    signed_limbs const &s = x.mag.size() >= y.mag.size() ? y : x;
+    signed_limbs res;
+    res.mag.resize(l.mag.size() + 1);
+    res.mag.back() = limbs_add(res.mag.data(), l.mag.data(), l.mag.size(), s.mag.data(), s.mag.size());
+    res.neg = neg;
+    trim(res);
+    return res;
+}
+
+// x + (negate_y ? -y : y)
+static signed_limbs add(signed_limbs const &x, signed_limbs const &y, bool negate_y = false)
+{
+    bool y_neg = y.neg != negate_y;
+    if (x.neg == y_neg) return abs_add(x, y, x.neg);
+
+    int cmp = limbs_cmp(x.mag.data(), x.mag.size(), y.mag.data(), y.mag.size());
+    signed_limbs const &l = cmp >= 0 ? x : y;
+    signed_limbs const &s = cmp >= 0 ? y : x;
+    signed_limbs res;
+    res.mag.resize(l.mag.size());
+    limbs_sub(res.mag.data(), l.mag.data(), l.mag.size(), s.mag.data(), s.mag.size());
+    res.neg = cmp >= 0 ? x.neg : y_neg;
+    trim(res);
+    return res;
+}
+
+static signed_limbs sub(signed_limbs const &x, signed_limbs const &y)
+{
+    return add(x, y, true);
+}
+
+static signed_limbs mul(signed_limbs const &x, signed_limbs const &y)
+{
+    signed_limbs res;
+    if (x.mag.empty() || y.mag.empty()) return res;
+    res.mag.resize(x.mag.size() + y.mag.size());
+    mul_limbs(res.mag.data(), x.mag.data(), x.mag.size(), y.mag.data(), y.mag.size());
+    res.neg = x.neg != y.neg;
+    trim(res);
+    return res;
+}
+
+static signed_limbs sqr(signed_limbs const &x)
+{
+    signed_limbs res;
+    if (x.mag.empty()) return res;
+    res.mag.resize(2 * x.mag.size());
+    sqr_limbs(res.mag.data(), x.mag.data(), x.mag.size());
+    trim(res);
+    return res;
+}
+
+static signed_limbs mul_small(signed_limbs x, uint32_t d)
+{
+    x.mag.push_back(limbs_mul_1(x.mag.data(), x.mag.data(), x.mag.size(), d));
+    trim(x);
+    return x;
+}
+
+static signed_limbs divexact_small(signed_limbs x, uint32_t d)
+{
+    limbs_divrem_1(x.mag.data(), x.mag.data(), x.mag.size(), d);
+    trim(x);
+    return x;
+}
+
+static void add_at(uint32_t *r, size_t rn, size_t off, signed_limbs const &x)
+{
+    if (!x.mag.empty()) limbs_add(r + off, r + off, rn - off, x.mag.data(), x.mag.size());
+}
+
+// r = the product with values r0, r1, rm1, rm2 and r4 at 0, 1, -1, -2 and
+// infinity, by Bodrato's interpolation sequence. Clobbers r1.
+static void toom3_interpolate(uint32_t *r, size_t rn, size_t k, signed_limbs &r0, signed_limbs &r1,
+                              signed_limbs &rm1, signed_limbs &rm2, signed_limbs &r4)
+{
+    signed_limbs r3 = divexact_small(sub(rm2, r1), 3);
+    r1 = divexact_small(sub(r1, rm1), 2);
+    signed_limbs r2 = sub(rm1, r0);
+    r3 = add(divexact_small(sub(r2, r3), 2), mul_small(r4, 2));
+    r2 = sub(add(r2, r1), r4);
+    r1 = sub(r1, r3);
+
+    std::fill(r, r + rn, 0);
+    add_at(r, rn, 0, r0);
+    add_at(r, rn, k, r1);
+    add_at(r, rn, 2 * k, r2);
+    add_at(r, rn, 3 * k, r3);
+    add_at(r, rn, 4 * k, r4);
+}
+
+void mul_toom3(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    if (an < bn)
+    {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    size_t k = (an + 2) / 3;
+    if (bn <= 2 * k)
+    {
+        mul_karatsuba(r, a, an, b, bn);
+        return;
+    }
+    size_t rn = an + bn;
+
+    signed_limbs a0(a, k), a1(a + k, k), a2(a + 2 * k, an - 2 * k);
+    signed_limbs b0(b, k), b1(b + k, k), b2(b + 2 * k, bn - 2 * k);
+
+    // Evaluate at 0, 1, -1, -2 and infinity.
+    signed_limbs pa = add(a0, a2);
+    signed_limbs pb = add(b0, b2);
+    signed_limbs a_1 = add(pa, a1), a_m1 = sub(pa, a1);
+    signed_limbs b_1 = add(pb, b1), b_m1 = sub(pb, b1);
+    signed_limbs a_m2 = sub(mul_small(add(a_m1, a2), 2), a0);
+    signed_limbs b_m2 = sub(mul_small(add(b_m1, b2), 2), b0);
+
+    signed_limbs r0, r1, rm1, rm2, r4;
+    parallel_invoke(mul_parallel_pool(bn),
+                    [&] { r0 = mul(a0, b0); },
+                    [&] { r1 = mul(a_1, b_1); },
+                    [&] { rm1 = mul(a_m1, b_m1); },
+                    [&] { rm2 = mul(a_m2, b_m2); },
+                    [&] { r4 = mul(a2, b2); });
+
+    toom3_interpolate(r, rn, k, r0, r1, rm1, rm2, r4);
+}
+
+void sqr_toom3(uint32_t *r, uint32_t const *a, size_t n)
+{
+    size_t k = (n + 2) / 3;
+    if (n <= 2 * k)
+    {
+        sqr_karatsuba(r, a, n);
+        return;
+    }
+
+    signed_limbs a0(a, k), a1(a + k, k), a2(a + 2 * k, n - 2 * k);
+    signed_limbs pa = add(a0, a2);
+    signed_limbs a_1 = add(pa, a1), a_m1 = sub(pa, a1);
+    signed_limbs a_m2 = sub(mul_small(add(a_m1, a2), 2), a0);
+
+    signed_limbs r0, r1, rm1, rm2, r4;
+    parallel_invoke(mul_parallel_pool(n),
+                    [&] { r0 = sqr(a0); },
+                    [&] { r1 = sqr(a_1); },
+                    [&] { rm1 = sqr(a_m1); },
+                    [&] { rm2 = sqr(a_m2); },
+                    [&] { r4 = sqr(a2); });
+
+    toom3_interpolate(r, 2 * n, k, r0, r1, rm1, rm2, r4);
+}
@@ -0,0 +1,67 @@
+#ifndef BIGINT_MUL_ENGINE_H
+#define BIGINT_MUL_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Operand lengths (in limbs of the shorter operand) at which mul_limbs
+// switches from one algorithm to the next. bench/mul_thresholds.cpp
+// measures the crossovers for the host.
+struct mul_thresholds
+{
+    size_t karatsuba;
+    size_t toom3;
+    size_t ntt;
+};
+
+// Longest product (an + bn) the three-prime NTT can represent exactly.
+const size_t NTT_MAX_LIMBS = static_cast<size_t>(1) << 23;
+
+mul_thresholds &mul_tuning();
+// The same crossovers for sqr_limbs, in limbs of the operand. Squaring
+// schoolbook does half the work of a product, so it holds out longer.
+mul_thresholds &sqr_tuning();
+
+// Multiplications whose shorter operand has at least threshold limbs run
+// their independent subproducts (Karatsuba and Toom-3 parts, unbalanced
+// slices, the three NTT primes and their forward transforms) on threads
+// threads, the caller included. threads = 1, the default, keeps every
+// multiplication on the calling thread. Change only while no
+// multiplication is running.
+struct mul_parallel_settings
+{
+    size_t threads;
+    size_t threshold;
+};
+
+mul_parallel_settings &mul_parallel();
+
+class thread_pool;
+
+// Pool to spread the subproducts of a multiplication with an n-limb
+// shorter operand over, or null when it should stay serial.
+thread_pool *mul_parallel_pool(size_t n);
+
+// r = a * b. r has an + bn limbs and must not overlap a or b.
+// Picks schoolbook, Karatsuba, Toom-3 or NTT by operand length. When a and b
+// are the same span it squares with sqr_limbs instead.
+void mul_limbs(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+// r = a * a. r has 2n limbs and must not overlap a. Each algorithm has a
+// squaring form: schoolbook forms every cross product once and doubles the
+// sum, Karatsuba and Toom-3 only recurse into squares, and the NTT
+// transforms the operand once.
+void sqr_limbs(uint32_t *r, uint32_t const *a, size_t n);
+
+// The individual algorithms, used by the dispatcher and the tuning benchmark.
+// Recursive calls go back through mul_limbs.
+void mul_schoolbook(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+void mul_karatsuba(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+void mul_toom3(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+void mul_ntt(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn);
+// Squaring forms, used by sqr_limbs. r has 2n limbs.
+void sqr_schoolbook(uint32_t *r, uint32_t const *a, size_t n);
+void sqr_karatsuba(uint32_t *r, uint32_t const *a, size_t n);
+void sqr_toom3(uint32_t *r, uint32_t const *a, size_t n);
+void sqr_ntt(uint32_t *r, uint32_t const *a, size_t n);
+
+#endif //BIGINT_MUL_ENGINE_H
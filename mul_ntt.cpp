@@ -0,0 +1,151 @@
+#include "mul_engine.h"
+#include "limb_ops.h"
+#include "thread_pool.h"
+#include <vector>
+#include <algorithm>
+
+// Three-prime number-theoretic transform. Each limb is one coefficient, so
+// a coefficient of the product is below min(an, bn) * B^2 and the CRT over
+// the three primes (product just above 2^86) recovers it exactly as long as
+// the transform length stays within 2^23.
+
+template <uint32_t P, uint32_t G>
+struct ntt_prime
+{
+    static uint32_t mul(uint32_t a, uint32_t b)
+    {
+        return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % P);
+    }
+
+    static uint32_t pow(uint32_t a, uint64_t e)
+    {
+        uint32_t res = 1;
+        while (e)
+        {
+            if (e & 1) res = mul(res, a);
+            a = mul(a, a);
+            e >>= 1;
+        }
+        return res;
+    }
+
+    static void transform(std::vector<uint32_t> &f, bool inverse)
+    {
+        size_t n = f.size();
+        for (size_t i = 1, j = 0; i < n; ++i)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(f[i], f[j]);
+        }
+
+        std::vector<uint32_t> roots(n / 2);
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            uint32_t w = pow(G, (P - 1) / len);
+            if (inverse) w = pow(w, P - 2);
+            size_t half = len / 2;
+            roots[0] = 1;
+            for (size_t k = 1; k < half; ++k) roots[k] = mul(roots[k - 1], w);
+
+            for (size_t i = 0; i < n; i += len)
+            {
+                for (size_t k = 0; k < half; ++k)
+                {
+                    uint32_t u = f[i + k];
+                    uint32_t v = mul(f[i + k + half], roots[k]);
+                    f[i + k] = u + v >= P ? u + v - P : u + v;
+                    f[i + k + half] = u >= v ? u - v : u + P - v;
+                }
+            }
+        }
+
+        if (inverse)
+        {
+            uint32_t n_inv = pow(static_cast<uint32_t>(n % P), P - 2);
+            for (size_t i = 0; i < n; ++i) f[i] = mul(f[i], n_inv);
+        }
+    }
+
+    // Reduces a into f modulo P and transforms it in place.
+    static void forward(std::vector<uint32_t> &f, uint32_t const *a, size_t an)
+    {
+        for (size_t i = 0; i < an; ++i) f[i] = a[i] % P;
+        transform(f, false);
+    }
+
+    // Cyclic convolution of a and b (or a with itself when b is null) modulo
+    // P. The two forward transforms run on pool when it is not null.
+    static std::vector<uint32_t> convolve(uint32_t const *a, size_t an, uint32_t const *b, size_t bn, size_t n,
+                                          thread_pool *pool)
+    {
+        std::vector<uint32_t> fa(n, 0);
+        if (b)
+        {
+            std::vector<uint32_t> fb(n, 0);
+            parallel_invoke(pool,
+                            [&] { forward(fb, b, bn); },
+                            [&] { forward(fa, a, an); });
+            for (size_t i = 0; i < n; ++i) fa[i] = mul(fa[i], fb[i]);
+        }
+        else
+        {
+            forward(fa, a, an);
+            for (size_t i = 0; i < n; ++i) fa[i] = mul(fa[i], fa[i]);
+        }
+
+        transform(fa, true);
+        return fa;
+    }
+};
+
+typedef ntt_prime<998244353, 3> prime1;
+typedef ntt_prime<167772161, 3> prime2;
+typedef ntt_prime<469762049, 3> prime3;
+
+static const uint64_t P1 = 998244353;
+static const uint64_t P2 = 167772161;
+static const uint64_t P3 = 469762049;
+
+static void ntt_convolve(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    size_t rn = an + (b ? bn : an);
+    size_t n = 1;
+    while (n < rn) n <<= 1;
+
+    thread_pool *pool = mul_parallel_pool(b ? std::min(an, bn) : an);
+    std::vector<uint32_t> c1, c2, c3;
+    parallel_invoke(pool,
+                    [&] { c1 = prime1::convolve(a, an, b, bn, n, pool); },
+                    [&] { c2 = prime2::convolve(a, an, b, bn, n, pool); },
+                    [&] { c3 = prime3::convolve(a, an, b, bn, n, pool); });
+
+    // Garner's CRT, then carry each coefficient into base-B limbs.
+    uint32_t const p1_inv_mod_p2 = prime2::pow(static_cast<uint32_t>(P1 % P2), P2 - 2);
+    uint32_t const p1p2_inv_mod_p3 = prime3::pow(static_cast<uint32_t>(P1 * P2 % P3), P3 - 2);
+
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < rn; ++i)
+    {
+        uint64_t x1 = c1[i];
+        uint64_t x2 = prime2::mul(static_cast<uint32_t>((c2[i] + P2 - x1 % P2) % P2), p1_inv_mod_p2);
+        uint64_t low = x1 + x2 * P1;
+        uint64_t x3 = prime3::mul(static_cast<uint32_t>((c3[i] + P3 - low % P3) % P3), p1p2_inv_mod_p3);
+
+        carry += low;
+        carry += static_cast<unsigned __int128>(x3) * (P1 * P2);
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= LIMB_BITS;
+    }
+}
+
+void mul_ntt(uint32_t *r, uint32_t const *a, size_t an, uint32_t const *b, size_t bn)
+{
+    ntt_convolve(r, a, an, b, bn);
+}
+
+void sqr_ntt(uint32_t *r, uint32_t const *a, size_t n)
+{
+    ntt_convolve(r, a, n, 0, 0);
+}
@@ -0,0 +1,331 @@
+#include "power_engine.h"
+#include "div_engine.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+typedef std::vector<uint32_t> limb_vector;
+}
+
+static void normalize(limb_vector &x)
+{
+    x.resize(limbs_normalized_size(x.data(), x.size()));
+}
+
+static uint64_t bit_length(uint32_t const *a, size_t n)
+{
+    if (n == 0) return 0;
+    return static_cast<uint64_t>(n - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clz(a[n - 1]));
+}
+
+static int compare(limb_vector const &x, limb_vector const &y)
+{
+    return limbs_cmp(x.data(), x.size(), y.data(), y.size());
+}
+
+// r = x * y for nonzero x and y; r keeps its capacity.
+static void multiply(limb_vector &r, limb_vector const &x, limb_vector const &y)
+{
+    r.resize(x.size() + y.size());
+    mul_limbs(r.data(), x.data(), x.size(), y.data(), y.size());
+    normalize(r);
+}
+
+// x *= m for nonzero x and m.
+static void multiply_1(limb_vector &x, uint32_t m)
+{
+    uint32_t carry = limbs_mul_1(x.data(), x.data(), x.size(), m);
+    if (carry != 0) x.push_back(carry);
+}
+
+// x = a^e for nonzero a and e >= 1, left to right: one squaring per bit of e
+// and one multiplication by a per set bit. t is scratch; both keep the
+// capacity they reach, so repeated calls do not allocate.
+static void power(limb_vector &x, limb_vector &t, limb_vector const &a, uint32_t e)
+{
+    x = a;
+    for (int i = 30 - __builtin_clz(e); i >= 0; --i)
+    {
+        multiply(t, x, x);
+        x.swap(t);
+        if ((e >> i & 1) == 0) continue;
+        if (a.size() == 1)
+        {
+            multiply_1(x, a[0]);
+        }
+        else
+        {
+            multiply(t, x, a);
+            x.swap(t);
+        }
+    }
+}
+
+size_t pow_limbs_bound(uint32_t const *a, size_t an, uint32_t e)
+{
+    return static_cast<size_t>((bit_length(a, an) * e + LIMB_BITS - 1) / LIMB_BITS) + 1;
+}
+
+size_t pow_limbs(uint32_t *r, uint32_t const *a, size_t an, uint32_t e)
+{
+    size_t rn = pow_limbs_bound(a, an, e);
+    std::fill(r, r + rn, 0);
+    if (e == 0)
+    {
+        r[0] = 1;
+        return 1;
+    }
+
+    // a = odd * 2^shift; the power of two comes back as a shift by shift * e.
+    size_t zero_limbs = 0;
+    while (a[zero_limbs] == 0) ++zero_limbs;
+    int zero_bits = __builtin_ctz(a[zero_limbs]);
+    limb_vector odd(an - zero_limbs);
+    limbs_rshift(odd.data(), a + zero_limbs, odd.size(), zero_bits);
+    normalize(odd);
+
+    uint64_t out_bits = bit_length(odd.data(), odd.size()) * e;
+    limb_vector x, t;
+    x.reserve(static_cast<size_t>(out_bits / LIMB_BITS) + 2);
+    t.reserve(x.capacity());
+    power(x, t, odd, e);
+
+    uint64_t shift = (static_cast<uint64_t>(zero_limbs) * LIMB_BITS + zero_bits) * e;
+    uint32_t *dst = r + static_cast<size_t>(shift / LIMB_BITS);
+    uint32_t carry = limbs_lshift(dst, x.data(), x.size(), static_cast<unsigned>(shift % LIMB_BITS));
+    if (carry != 0) dst[x.size()] = carry;
+    return limbs_normalized_size(r, rn);
+}
+
+// Whether x^k <= v, for x^k computed without overflow.
+static bool power_at_most(uint64_t x, uint32_t k, uint64_t v)
+{
+    uint64_t p = 1;
+    for (uint32_t i = 0; i < k; ++i)
+    {
+        if (x != 0 && p > v / x) return false;
+        p *= x;
+    }
+    return p <= v;
+}
+
+static uint64_t root_64(uint64_t v, uint32_t k)
+{
+    uint64_t x = static_cast<uint64_t>(std::pow(static_cast<double>(v), 1.0 / k));
+    while (x > 0 && !power_at_most(x, k, v)) --x;
+    while (power_at_most(x + 1, k, v)) ++x;
+    return x;
+}
+
+// floor(n^(1/k)) for k >= 2, setting exact to whether it is the exact root.
+// The root of n with its low k * m bits dropped, plus one, shifted up by m
+// bits, lies above the root and is correct to about half its bits; Newton
+// steps x <- ((k - 1) x + n / x^(k - 1)) / k then fall monotonically onto
+// the floor, each about doubling the correct bits. m is chosen so that the
+// recursive root has half the bits, so the total cost is a constant number
+// of full-length powers and divisions.
+static limb_vector root(limb_vector const &n, uint32_t k, bool &exact)
+{
+    uint64_t bits = bit_length(n.data(), n.size());
+    limb_vector x;
+    exact = bits == 0;
+    if (bits == 0) return x;
+    if (bits <= k)
+    {
+        exact = bits == 1;
+        x.assign(1, 1);
+        return x;
+    }
+    if (bits <= 64)
+    {
+        uint64_t v = n[0] | (n.size() > 1 ? static_cast<uint64_t>(n[1]) << 32 : 0);
+        uint64_t s = root_64(v, k);
+        x.push_back(static_cast<uint32_t>(s));
+        x.push_back(static_cast<uint32_t>(s >> 32));
+        normalize(x);
+        exact = power_at_most(s, k, v) && !power_at_most(s, k, v - 1);
+        return x;
+    }
+
+    uint64_t m = bits / (2 * k);
+    if (m == 0)
+    {
+        // The root is below 4; start from 2^ceil(bits / k).
+        x.assign(1, 1u << ((bits + k - 1) / k));
+    }
+    else
+    {
+        uint64_t drop = m * k;
+        limb_vector top(n.size() - static_cast<size_t>(drop / LIMB_BITS));
+        limbs_rshift(top.data(), n.data() + drop / LIMB_BITS, top.size(), static_cast<unsigned>(drop % LIMB_BITS));
+        normalize(top);
+        bool top_exact;
+        limb_vector s = root(top, k, top_exact);
+        s.push_back(0);
+        limbs_add_1(s.data(), s.data(), s.size(), 1);
+        normalize(s);
+        x.assign(static_cast<size_t>(m / LIMB_BITS) + s.size() + 1, 0);
+        x.back() = limbs_lshift(x.data() + m / LIMB_BITS, s.data(), s.size(), static_cast<unsigned>(m % LIMB_BITS));
+        normalize(x);
+    }
+
+    limb_vector p, t, q, rem;
+    for (;;)
+    {
+        if (k == 2)
+        {
+            p = x;
+        }
+        else
+        {
+            power(p, t, x, k - 1);
+        }
+        multiply(t, p, x);
+        int c = compare(t, n);
+        if (c <= 0)
+        {
+            exact = c == 0;
+            return x;
+        }
+
+        q.assign(1, 0);
+        if (p.size() <= n.size())
+        {
+            q.assign(n.size() - p.size() + 1, 0);
+            rem.resize(p.size());
+            div_limbs(q.data(), rem.data(), n.data(), n.size(), p.data(), p.size());
+        }
+        multiply_1(x, k - 1);
+        x.resize(std::max(x.size(), q.size()) + 1, 0);
+        q.resize(x.size(), 0);
+        limbs_add(x.data(), x.data(), x.size(), q.data(), q.size());
+        limbs_divrem_1(x.data(), x.data(), x.size(), k);
+        normalize(x);
+    }
+}
+
+size_t root_limbs(uint32_t *r, uint32_t const *a, size_t an, uint32_t k)
+{
+    std::fill(r, r + an / k + 1, 0);
+    if (k == 1)
+    {
+        std::copy(a, a + an, r);
+        return an;
+    }
+    bool exact;
+    limb_vector x = root(limb_vector(a, a + an), k, exact);
+    std::copy(x.begin(), x.end(), r);
+    return x.size();
+}
+
+static bool is_prime(uint64_t k)
+{
+    if (k < 2) return false;
+    for (uint64_t d = 2; d * d <= k; ++d)
+    {
+        if (k % d == 0) return false;
+    }
+    return true;
+}
+
+static uint32_t mod_1(uint32_t const *a, size_t n, uint32_t q)
+{
+    uint64_t r = 0;
+    for (size_t i = n; i-- > 0;)
+    {
+        r = (r << 32 | a[i]) % q;
+    }
+    return static_cast<uint32_t>(r);
+}
+
+static uint32_t pow_mod_1(uint64_t b, uint64_t e, uint32_t q)
+{
+    uint64_t r = 1;
+    for (b %= q; e != 0; e >>= 1)
+    {
+        if (e & 1) r = r * b % q;
+        b = b * b % q;
+    }
+    return static_cast<uint32_t>(r);
+}
+
+// Whether a can be a p-th power judging by its residues modulo a few primes
+// q = 1 (mod p): a p-th power is 0 or a p-th power residue modulo q, and a
+// non-residue is caught by each q with probability 1 - 1 / p.
+static bool power_residues(uint32_t const *a, size_t an, uint64_t p)
+{
+    int tried = 0;
+    for (uint64_t q = p + 1; tried < 4 && q <= UINT32_MAX; q += p)
+    {
+        if (!is_prime(q)) continue;
+        ++tried;
+        uint32_t r = mod_1(a, an, static_cast<uint32_t>(q));
+        if (r != 0 && pow_mod_1(r, (q - 1) / p, static_cast<uint32_t>(q)) != 1) return false;
+    }
+    return true;
+}
+
+// The only odd b below 2^32 with b^p = a (mod 2^32) for odd a and odd p:
+// p is invertible modulo 2^30, the exponent of the odd residues, so
+// b = a^(1 / p mod 2^30).
+static uint32_t odd_root_32(uint32_t a, uint64_t p)
+{
+    uint32_t inv = 1;
+    for (int i = 0; i < 5; ++i)
+    {
+        inv *= 2 - static_cast<uint32_t>(p) * inv;
+    }
+    uint32_t e = inv & ((1u << 30) - 1);
+    uint32_t r = 1;
+    for (; e != 0; e >>= 1)
+    {
+        if (e & 1) r *= a;
+        a *= a;
+    }
+    return r;
+}
+
+// Whether b^p = a, checking the bit length before computing the power.
+static bool is_power_of(uint32_t b, uint64_t p, uint32_t const *a, size_t an)
+{
+    uint64_t bits = bit_length(a, an);
+    double log_bits = static_cast<double>(p) * std::log2(static_cast<double>(b));
+    if (log_bits < static_cast<double>(bits) - 1.5 || log_bits > static_cast<double>(bits) + 0.5) return false;
+    limb_vector base(1, b), x, t;
+    power(x, t, base, static_cast<uint32_t>(p));
+    return limbs_cmp(x.data(), x.size(), a, an) == 0;
+}
+
+// A perfect power is a perfect p-th power for some prime p, and p is at
+// most the bit length. If 2^t exactly divides a, p also divides t. For odd
+// a and p large enough that the root fits in a limb, the root is fixed by
+// the low limb; otherwise residues weed out most p before a root is taken.
+bool perfect_power_limbs(uint32_t const *a, size_t an, bool odd_only)
+{
+    if (an == 0 || (an == 1 && a[0] == 1)) return true;
+    uint64_t bits = bit_length(a, an);
+    size_t zero_limbs = 0;
+    while (a[zero_limbs] == 0) ++zero_limbs;
+    uint64_t twos = static_cast<uint64_t>(zero_limbs) * LIMB_BITS + __builtin_ctz(a[zero_limbs]);
+
+    limb_vector n(a, a + an);
+    for (uint64_t p = odd_only ? 3 : 2; p <= bits; p += p == 2 ? 1 : 2)
+    {
+        if (twos != 0 && twos % p != 0) continue;
+        if (!is_prime(p)) continue;
+        if (twos == 0 && p != 2 && bits <= p * LIMB_BITS)
+        {
+            if (is_power_of(odd_root_32(a[0], p), p, a, an)) return true;
+            continue;
+        }
+        if (!power_residues(a, an, p)) continue;
+        bool exact;
+        root(n, static_cast<uint32_t>(p), exact);
+        if (exact) return true;
+    }
+    return false;
+}
@@ -0,0 +1,24 @@
+#ifndef BIGINT_POWER_ENGINE_H
+#define BIGINT_POWER_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Inputs are normalized: a has an limbs and, unless an is 0, a nonzero top
+// limb.
+
+// Limbs a^e can take, for an > 0.
+size_t pow_limbs_bound(uint32_t const *a, size_t an, uint32_t e);
+// r = a^e for an > 0. r has pow_limbs_bound(a, an, e) limbs and must not
+// overlap a. Returns the length of the result.
+size_t pow_limbs(uint32_t *r, uint32_t const *a, size_t an, uint32_t e);
+
+// r = floor(a^(1/k)) for k >= 1. r has an / k + 1 limbs and must not
+// overlap a. Returns the length of the result.
+size_t root_limbs(uint32_t *r, uint32_t const *a, size_t an, uint32_t k);
+
+// Whether a = b^k for some b and some k >= 2, restricted to odd k when
+// odd_only is set. 0 and 1 count.
+bool perfect_power_limbs(uint32_t const *a, size_t an, bool odd_only);
+
+#endif //BIGINT_POWER_ENGINE_H
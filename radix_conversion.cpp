@@ -0,0 +1,450 @@
+#include "radix_conversion.h"
+#include "limb_ops.h"
+#include "mul_engine.h"
+#include "div_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static char const LOWER_DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+static char const UPPER_DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+namespace
+{
+// How a base is converted: power-of-two bases by shift bits per digit,
+// others through chunks of digits digits worth chunk_base, the largest
+// power of the base that fits in a limb (10^9 in decimal).
+struct radix_params
+{
+    unsigned base;
+    unsigned shift;
+    unsigned digits;
+    uint32_t chunk_base;
+};
+
+typedef std::vector<std::vector<uint32_t> > power_table;
+
+// Buffers digits for a radix_output so it sees a few large writes.
+struct digit_writer
+{
+    radix_output &out;
+    char const *alphabet;
+    char buf[512];
+    size_t len;
+
+    digit_writer(radix_output &out, bool upper) : out(out), alphabet(upper ? UPPER_DIGITS : LOWER_DIGITS), len(0) {}
+
+    void put(unsigned digit)
+    {
+        if (this->len == sizeof(this->buf)) this->flush();
+        this->buf[this->len++] = this->alphabet[digit];
+    }
+
+    void flush()
+    {
+        if (this->len != 0) this->out.write(this->buf, this->len);
+        this->len = 0;
+    }
+};
+
+// Fills a caller's array; overflow is set once it runs out.
+struct array_output : radix_output
+{
+    char *out;
+    size_t size;
+    size_t len;
+    bool overflow;
+
+    array_output(char *out, size_t size) : out(out), size(size), len(0), overflow(false) {}
+
+    void write(char const *s, size_t n)
+    {
+        if (this->overflow || n > this->size - this->len)
+        {
+            this->overflow = true;
+            return;
+        }
+        std::memcpy(this->out + this->len, s, n);
+        this->len += n;
+    }
+};
+}
+
+static radix_params params_of(unsigned base)
+{
+    radix_params p = {base, 0, 0, 1};
+    if ((base & (base - 1)) == 0)
+    {
+        p.shift = static_cast<unsigned>(__builtin_ctz(base));
+        p.digits = LIMB_BITS / p.shift;
+        return p;
+    }
+    uint64_t chunk = 1;
+    while (chunk * base <= LIMB_MAX)
+    {
+        chunk *= base;
+        ++p.digits;
+    }
+    p.chunk_base = static_cast<uint32_t>(chunk);
+    return p;
+}
+
+// powers[l] = chunk_base^(2^l), squared up from the previous entry.
+static void extend_powers(power_table &powers, size_t levels, radix_params const &p)
+{
+    if (powers.empty()) powers.push_back(std::vector<uint32_t>(1, p.chunk_base));
+    while (powers.size() < levels)
+    {
+        std::vector<uint32_t> const &prev = powers.back();
+        std::vector<uint32_t> next(2 * prev.size());
+        mul_limbs(&next[0], &prev[0], prev.size(), &prev[0], prev.size());
+        next.resize(limbs_normalized_size(&next[0], next.size()));
+        powers.push_back(next);
+    }
+}
+
+static void put_chunk(uint32_t chunk, bool pad, radix_params const &p, digit_writer &out)
+{
+    unsigned buf[32];
+    size_t len = 0;
+    while (chunk != 0 || (pad && len < p.digits))
+    {
+        buf[len++] = chunk % p.base;
+        chunk /= p.base;
+    }
+    while (len > 0) out.put(buf[--len]);
+}
+
+static size_t digit_count(uint32_t chunk, unsigned base)
+{
+    size_t len = 0;
+    for (; chunk != 0; chunk /= base) ++len;
+    return len;
+}
+
+// Writes a[0, n), left-padded with zeros to digits characters.
+static void to_radix_basecase(uint32_t const *a, size_t n, size_t digits, radix_params const &p, digit_writer &out)
+{
+    std::vector<uint32_t> t(a, a + n);
+    std::vector<uint32_t> chunks;
+    while (n > 0)
+    {
+        chunks.push_back(limbs_divrem_1(&t[0], &t[0], n, p.chunk_base));
+        n = limbs_normalized_size(&t[0], n);
+    }
+
+    size_t produced = chunks.empty() ? 0 : digit_count(chunks.back(), p.base) + p.digits * (chunks.size() - 1);
+    for (; digits > produced; --digits) out.put(0);
+    for (size_t i = chunks.size(); i > 0; --i)
+    {
+        put_chunk(chunks[i - 1], i != chunks.size(), p, out);
+    }
+}
+
+static void to_radix_rec(uint32_t const *a, size_t n, size_t digits, radix_params const &p, power_table const &powers,
+                         digit_writer &out)
+{
+    n = limbs_normalized_size(a, n);
+    if (n < RADIX_DC_THRESHOLD)
+    {
+        to_radix_basecase(a, n, digits, p, out);
+        return;
+    }
+
+    // Split around the largest cached power of about half the length.
+    size_t level = powers.size() - 1;
+    while (level > 0 && 2 * powers[level].size() > n + 1) --level;
+    std::vector<uint32_t> const &pw = powers[level];
+    size_t low_digits = static_cast<size_t>(p.digits) << level;
+
+    std::vector<uint32_t> q(n - pw.size() + 1), r(pw.size());
+    div_limbs(&q[0], &r[0], a, n, &pw[0], pw.size());
+    to_radix_rec(&q[0], q.size(), digits > low_digits ? digits - low_digits : 0, p, powers, out);
+    to_radix_rec(&r[0], r.size(), low_digits, p, powers, out);
+}
+
+// One pass from the top digit down, each digit a window of shift bits.
+static void to_radix_pow2(uint32_t const *a, size_t n, radix_params const &p, digit_writer &out)
+{
+    uint64_t bits = static_cast<uint64_t>(n - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clz(a[n - 1]));
+    uint32_t mask = p.base - 1;
+    for (uint64_t i = (bits + p.shift - 1) / p.shift; i-- > 0;)
+    {
+        uint64_t pos = i * p.shift;
+        size_t limb = static_cast<size_t>(pos / LIMB_BITS);
+        unsigned off = static_cast<unsigned>(pos % LIMB_BITS);
+        uint64_t window = a[limb] >> off;
+        if (off + p.shift > LIMB_BITS && limb + 1 < n) window |= static_cast<uint64_t>(a[limb + 1]) << (LIMB_BITS - off);
+        out.put(static_cast<unsigned>(window & mask));
+    }
+}
+
+void limbs_to_radix(uint32_t const *a, size_t n, unsigned base, bool upper, radix_output &out)
+{
+    digit_writer writer(out, upper);
+    n = limbs_normalized_size(a, n);
+    radix_params p = params_of(base);
+    if (n == 0)
+    {
+        writer.put(0);
+    }
+    else if (p.shift != 0)
+    {
+        to_radix_pow2(a, n, p, writer);
+    }
+    else
+    {
+        power_table powers;
+        extend_powers(powers, 1, p);
+        while (2 * powers.back().size() <= n) extend_powers(powers, powers.size() + 1, p);
+        to_radix_rec(a, n, 0, p, powers, writer);
+    }
+    writer.flush();
+}
+
+// Digits from the last one back, ending at out + size, then moved to out.
+static size_t to_radix_array_basecase(uint32_t const *a, size_t n, radix_params const &p, char const *alphabet,
+                                      char *out, size_t size)
+{
+    uint32_t t[RADIX_DC_THRESHOLD];
+    std::copy(a, a + n, t);
+    char *at = out + size;
+    while (n > 0)
+    {
+        uint32_t chunk = limbs_divrem_1(t, t, n, p.chunk_base);
+        n = limbs_normalized_size(t, n);
+        for (unsigned i = 0; i < p.digits && (n != 0 || chunk != 0); ++i)
+        {
+            if (at == out) return 0;
+            *--at = alphabet[chunk % p.base];
+            chunk /= p.base;
+        }
+    }
+    size_t len = static_cast<size_t>(out + size - at);
+    std::memmove(out, at, len);
+    return len;
+}
+
+size_t limbs_to_radix(uint32_t const *a, size_t n, unsigned base, bool upper, char *out, size_t size)
+{
+    n = limbs_normalized_size(a, n);
+    radix_params p = params_of(base);
+    char const *alphabet = upper ? UPPER_DIGITS : LOWER_DIGITS;
+    if (n == 0 || p.shift != 0)
+    {
+        size_t bits = n == 0 ? 0 : (n - 1) * LIMB_BITS + (LIMB_BITS - __builtin_clz(a[n - 1]));
+        size_t len = radix_digits_bound(bits, base);
+        if (len > size) return 0;
+        array_output to_array(out, size);
+        limbs_to_radix(a, n, base, upper, to_array);
+        return len;
+    }
+    if (n < RADIX_DC_THRESHOLD) return to_radix_array_basecase(a, n, p, alphabet, out, size);
+
+    array_output to_array(out, size);
+    limbs_to_radix(a, n, base, upper, to_array);
+    return to_array.overflow ? 0 : to_array.len;
+}
+
+size_t radix_digits_bound(size_t bits, unsigned base)
+{
+    if (bits == 0) return 1;
+    if ((base & (base - 1)) == 0)
+    {
+        unsigned shift = static_cast<unsigned>(__builtin_ctz(base));
+        return (bits + shift - 1) / shift;
+    }
+    // bits * log_base(2), plus a digit for rounding the logarithm.
+    double digits = static_cast<double>(bits) * (std::log(2.0) / std::log(static_cast<double>(base)));
+    return static_cast<size_t>(digits) + 2;
+}
+
+size_t radix_limbs_bound(size_t len, unsigned base)
+{
+    radix_params p = params_of(base);
+    if (p.shift != 0) return (len / LIMB_BITS) * p.shift + ((len % LIMB_BITS) * p.shift + LIMB_BITS - 1) / LIMB_BITS;
+    return (len + p.digits - 1) / p.digits;
+}
+
+// Horner's rule over chunks, most significant first.
+static std::vector<uint32_t> from_chunks_basecase(uint32_t const *c, size_t count, radix_params const &p)
+{
+    std::vector<uint32_t> res;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t carry = res.empty() ? 0 : limbs_mul_1(&res[0], &res[0], res.size(), p.chunk_base);
+        if (carry != 0) res.push_back(carry);
+        carry = res.empty() ? c[i] : limbs_add_1(&res[0], &res[0], res.size(), c[i]);
+        if (carry != 0) res.push_back(carry);
+    }
+    res.resize(limbs_normalized_size(res.data(), res.size()));
+    return res;
+}
+
+// The chunks as digits of base chunk_base, most significant first.
+static std::vector<uint32_t> from_chunks_rec(uint32_t const *c, size_t count, radix_params const &p, power_table &powers)
+{
+    if (count <= RADIX_DC_THRESHOLD) return from_chunks_basecase(c, count, p);
+
+    // The low part is the largest 2^level chunks that leave a high part.
+    size_t level = 0;
+    while ((static_cast<size_t>(1) << (level + 1)) < count) ++level;
+    extend_powers(powers, level + 1, p);
+    size_t low_count = static_cast<size_t>(1) << level;
+
+    std::vector<uint32_t> high = from_chunks_rec(c, count - low_count, p, powers);
+    std::vector<uint32_t> low = from_chunks_rec(c + count - low_count, low_count, p, powers);
+    if (high.empty()) return low;
+
+    std::vector<uint32_t> const &pw = powers[level];
+    std::vector<uint32_t> res(high.size() + pw.size());
+    mul_limbs(&res[0], &high[0], high.size(), &pw[0], pw.size());
+    if (!low.empty()) limbs_add(&res[0], &res[0], res.size(), &low[0], low.size());
+    res.resize(limbs_normalized_size(&res[0], res.size()));
+    return res;
+}
+
+// Appends bits bits of value above the bits already in res.
+static void pack_bits(std::vector<uint32_t> &res, uint64_t &acc, unsigned &acc_bits, uint32_t value, unsigned bits)
+{
+    acc |= static_cast<uint64_t>(value) << acc_bits;
+    acc_bits += bits;
+    if (acc_bits >= LIMB_BITS)
+    {
+        res.push_back(static_cast<uint32_t>(acc));
+        acc >>= LIMB_BITS;
+        acc_bits -= LIMB_BITS;
+    }
+}
+
+// Least significant digit first, straight into r.
+static size_t from_radix_pow2(char const *s, size_t len, radix_params const &p, uint32_t *r)
+{
+    size_t n = 0;
+    uint64_t acc = 0;
+    unsigned acc_bits = 0;
+    for (size_t i = len; i-- > 0;)
+    {
+        acc |= static_cast<uint64_t>(radix_digit_value(s[i])) << acc_bits;
+        acc_bits += p.shift;
+        if (acc_bits >= LIMB_BITS)
+        {
+            r[n++] = static_cast<uint32_t>(acc);
+            acc >>= LIMB_BITS;
+            acc_bits -= LIMB_BITS;
+        }
+    }
+    if (acc_bits != 0) r[n++] = static_cast<uint32_t>(acc);
+    return limbs_normalized_size(r, n);
+}
+
+// Horner's rule in r, a limb-sized chunk of digits per step.
+static size_t from_radix_horner(char const *s, size_t len, radix_params const &p, uint32_t *r)
+{
+    size_t n = 0;
+    size_t chunk_len = len % p.digits == 0 ? p.digits : len % p.digits;
+    for (size_t pos = 0; pos < len; pos += chunk_len, chunk_len = p.digits)
+    {
+        uint32_t chunk = 0, scale = 1;
+        for (size_t j = 0; j < chunk_len; ++j)
+        {
+            chunk = chunk * p.base + radix_digit_value(s[pos + j]);
+            scale *= p.base;
+        }
+        r[n] = limbs_mul_1(r, r, n, scale);
+        limbs_add_1(r, r, n + 1, chunk);
+        if (r[n] != 0 || n == 0) ++n;
+    }
+    return limbs_normalized_size(r, n);
+}
+
+size_t limbs_from_radix_to(char const *s, size_t len, unsigned base, uint32_t *r)
+{
+    radix_params p = params_of(base);
+    if (p.shift != 0) return from_radix_pow2(s, len, p, r);
+    if (radix_limbs_bound(len, base) <= RADIX_INPLACE_CHUNKS) return from_radix_horner(s, len, p, r);
+
+    std::vector<uint32_t> res;
+    limbs_from_radix(s, len, base, res);
+    std::copy(res.begin(), res.end(), r);
+    return res.size();
+}
+
+bool limbs_from_radix(char const *s, size_t len, unsigned base, std::vector<uint32_t> &out)
+{
+    radix_params p = params_of(base);
+    std::vector<uint32_t> res;
+    if (p.shift != 0)
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            if (radix_digit_value(s[i]) >= base) return false;
+        }
+        res.resize(radix_limbs_bound(len, base));
+        res.resize(from_radix_pow2(s, len, p, res.data()));
+        out.swap(res);
+        return true;
+    }
+
+    // Chunks of p.digits digits, the first one taking the remainder.
+    std::vector<uint32_t> chunks((len + p.digits - 1) / p.digits);
+    size_t chunk_len = len % p.digits == 0 ? p.digits : len % p.digits;
+    for (size_t pos = 0, i = 0; pos < len; pos += chunk_len, chunk_len = p.digits, ++i)
+    {
+        uint32_t chunk = 0;
+        for (size_t j = 0; j < chunk_len; ++j)
+        {
+            unsigned d = radix_digit_value(s[pos + j]);
+            if (d >= base) return false;
+            chunk = chunk * base + d;
+        }
+        chunks[i] = chunk;
+    }
+    power_table powers;
+    res = from_chunks_rec(chunks.data(), chunks.size(), p, powers);
+    out.swap(res);
+    return true;
+}
+
+radix_reader::radix_reader(unsigned base) : base(base), chunk_digits(params_of(base).digits), pending(0), chunk(0) {}
+
+std::vector<uint32_t> radix_reader::finish()
+{
+    radix_params p = params_of(this->base);
+    std::vector<uint32_t> res;
+    if (p.shift != 0)
+    {
+        // The pending digits are the lowest; then whole chunks upwards.
+        res.reserve(this->chunks.size() + 1);
+        uint64_t acc = 0;
+        unsigned acc_bits = 0;
+        pack_bits(res, acc, acc_bits, this->chunk, this->pending * p.shift);
+        for (size_t i = this->chunks.size(); i-- > 0;)
+        {
+            pack_bits(res, acc, acc_bits, this->chunks[i], p.digits * p.shift);
+        }
+        if (acc_bits != 0) res.push_back(static_cast<uint32_t>(acc));
+        res.resize(limbs_normalized_size(res.data(), res.size()));
+    }
+    else
+    {
+        power_table powers;
+        res = from_chunks_rec(this->chunks.data(), this->chunks.size(), p, powers);
+        if (this->pending != 0)
+        {
+            // res * base^pending + the pending digits.
+            uint32_t scale = 1;
+            for (unsigned i = 0; i < this->pending; ++i) scale *= this->base;
+            uint32_t carry = res.empty() ? 0 : limbs_mul_1(&res[0], &res[0], res.size(), scale);
+            if (carry != 0) res.push_back(carry);
+            carry = res.empty() ? this->chunk : limbs_add_1(&res[0], &res[0], res.size(), this->chunk);
+            if (carry != 0) res.push_back(carry);
+            res.resize(limbs_normalized_size(res.data(), res.size()));
+        }
+    }
+
+    this->chunks.clear();
+    this->chunk = 0;
+    this->pending = 0;
+    return res;
+}
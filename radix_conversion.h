@@ -0,0 +1,108 @@
+#ifndef BIGINT_RADIX_CONVERSION_H
+#define BIGINT_RADIX_CONVERSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Limb count below which conversion works chunk by chunk (as many digits as
+// fit in a limb per limb operation, 9 in decimal) instead of splitting
+// around a power of the base. Power-of-two bases never need either.
+const size_t RADIX_DC_THRESHOLD = 30;
+
+// Chunk count above which limbs_from_radix_to leaves Horner's rule, in
+// place but quadratic, for the divide-and-conquer conversion.
+const size_t RADIX_INPLACE_CHUNKS = 320;
+
+// Receives the digits of a conversion, most significant first, in pieces.
+struct radix_output
+{
+    virtual ~radix_output() {}
+    virtual void write(char const *s, size_t n) = 0;
+};
+
+struct string_output : radix_output
+{
+    std::string &out;
+
+    explicit string_output(std::string &out) : out(out) {}
+
+    void write(char const *s, size_t n)
+    {
+        this->out.append(s, n);
+    }
+};
+
+// The value of c as a digit (0-9, then a-z or A-Z for 10-35), or 36 when
+// it is none.
+inline unsigned radix_digit_value(char c)
+{
+    if (c >= '0' && c <= '9') return static_cast<unsigned>(c - '0');
+    if (c >= 'a' && c <= 'z') return static_cast<unsigned>(c - 'a') + 10;
+    if (c >= 'A' && c <= 'Z') return static_cast<unsigned>(c - 'A') + 10;
+    return 36;
+}
+
+// Writes the digits of a in base (2 to 36), without leading zeros ("0" for
+// zero). Power-of-two bases are sliced straight off the limbs.
+void limbs_to_radix(uint32_t const *a, size_t n, unsigned base, bool upper, radix_output &out);
+
+// Parses len digits of base into normalized little-endian limbs. False,
+// leaving out alone, when a character is not a digit of base.
+bool limbs_from_radix(char const *s, size_t len, unsigned base, std::vector<uint32_t> &out);
+
+// Writes the digits of a to out[0, size) as above and returns their count,
+// or 0 when they do not fit. Power-of-two bases and values shorter than
+// RADIX_DC_THRESHOLD limbs need nothing beyond the stack; longer ones go
+// through the divide-and-conquer conversion and its scratch.
+size_t limbs_to_radix(uint32_t const *a, size_t n, unsigned base, bool upper, char *out, size_t size);
+
+// At least the number of digits in base of a value of bits bits (and 1 for
+// zero); exact for power-of-two bases.
+size_t radix_digits_bound(size_t bits, unsigned base);
+// Limbs enough to hold any len digits of base.
+size_t radix_limbs_bound(size_t len, unsigned base);
+
+// Parses len digits of base, all already checked, into r, which has
+// radix_limbs_bound(len, base) limbs, and returns the normalized length.
+// Only r is written, except for over RADIX_INPLACE_CHUNKS limb-sized chunks
+// of a non-power-of-two base, which take the divide-and-conquer route.
+size_t limbs_from_radix_to(char const *s, size_t len, unsigned base, uint32_t *r);
+
+// Collects digits one at a time, most significant first, for input whose
+// length is not known up front. Digits are packed a limb-sized chunk at a
+// time as they arrive, so the text itself is never held.
+struct radix_reader
+{
+    explicit radix_reader(unsigned base);
+
+    // digit < base.
+    void push(unsigned digit)
+    {
+        this->chunk = this->chunk * this->base + digit;
+        if (++this->pending == this->chunk_digits)
+        {
+            this->chunks.push_back(this->chunk);
+            this->chunk = 0;
+            this->pending = 0;
+        }
+    }
+
+    size_t digits() const
+    {
+        return this->chunks.size() * this->chunk_digits + this->pending;
+    }
+
+    // The value of the digits so far as normalized limbs; resets the reader.
+    std::vector<uint32_t> finish();
+
+private:
+    unsigned base;
+    unsigned chunk_digits;
+    unsigned pending;
+    uint32_t chunk;
+    std::vector<uint32_t> chunks;
+};
+
+#endif //BIGINT_RADIX_CONVERSION_H
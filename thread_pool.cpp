@@ -0,0 +1,177 @@
+#include "thread_pool.h"
+
+// Pool and queue index of the calling thread when it is a pool worker.
+static thread_local thread_pool *current_pool = 0;
+static thread_local size_t current_queue = 0;
+
+thread_pool::thread_pool(size_t workers) : pending(0), stopping(false)
+{
+    for (size_t i = 0; i <= workers; ++i)
+    {
+        queues.push_back(std::unique_ptr<task_queue>(new task_queue));
+    }
+    for (size_t i = 1; i <= workers; ++i)
+    {
+        threads.push_back(std::thread(&thread_pool::worker_loop, this, i));
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+}
+
+size_t thread_pool::workers() const
+{
+    return threads.size();
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+    size_t home = current_pool == this ? current_queue : 0;
+    // Counted before it is queued, so pending never drops below zero when a
+    // worker takes the task at once.
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        ++pending;
+    }
+    {
+        std::lock_guard<std::mutex> guard(queues[home]->lock);
+        queues[home]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+bool thread_pool::take(size_t home, std::function<void()> &task)
+{
+    {
+        task_queue &own = *queues[home];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --pending;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < queues.size(); ++k)
+    {
+        task_queue &victim = *queues[(home + k) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool thread_pool::run_pending()
+{
+    std::function<void()> task;
+    if (!take(current_pool == this ? current_queue : 0, task)) return false;
+    task();
+    return true;
+}
+
+void thread_pool::worker_loop(size_t index)
+{
+    current_pool = this;
+    current_queue = index;
+    for (;;)
+    {
+        std::function<void()> task;
+        if (take(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        wake.wait(guard, [this] { return stopping || pending > 0; });
+        if (stopping) return;
+    }
+}
+
+task_group::task_group(thread_pool &pool) : pool(pool), outstanding(0)
+{
+}
+
+task_group::~task_group()
+{
+    while (outstanding.load(std::memory_order_acquire) != 0)
+    {
+        if (!pool.run_pending()) std::this_thread::yield();
+    }
+}
+
+void task_group::run(std::function<void()> task)
+{
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+    pool.submit([this, task]
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> guard(error_lock);
+            if (!error) error = std::current_exception();
+        }
+        // Last touch of the group: wait() may return and destroy it.
+        outstanding.fetch_sub(1, std::memory_order_release);
+    });
+}
+
+void task_group::wait()
+{
+    while (outstanding.load(std::memory_order_acquire) != 0)
+    {
+        if (!pool.run_pending()) std::this_thread::yield();
+    }
+    if (error)
+    {
+        std::exception_ptr e = error;
+        error = std::exception_ptr();
+        std::rethrow_exception(e);
+    }
+}
+
+void run_all(thread_pool *pool, std::function<void()> const *tasks, size_t count)
+{
+    if (count == 0) return;
+    if (pool == 0 || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i) tasks[i]();
+        return;
+    }
+
+    task_group group(*pool);
+    for (size_t i = 0; i + 1 < count; ++i) group.run(tasks[i]);
+    try
+    {
+        tasks[count - 1]();
+    }
+    catch (...)
+    {
+        try
+        {
+            group.wait();
+        }
+        catch (...)
+        {
+        }
+        throw;
+    }
+    group.wait();
+}
@@ -0,0 +1,103 @@
+#ifndef BIGINT_THREAD_POOL_H
+#define BIGINT_THREAD_POOL_H
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for fork-join parallelism. Each worker pops its own
+// newest task first and steals the oldest task of another worker when it
+// runs dry; tasks submitted from outside the pool go to a shared queue.
+// Threads waiting on a task_group run pending tasks instead of blocking,
+// so tasks may fork and wait on subtasks without deadlocking the pool.
+class thread_pool
+{
+public:
+    explicit thread_pool(size_t workers);
+    ~thread_pool();
+
+    size_t workers() const;
+
+    void submit(std::function<void()> task);
+    // Runs one pending task on the calling thread. False if none was found.
+    bool run_pending();
+
+private:
+    struct task_queue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    thread_pool(thread_pool const &);
+    thread_pool &operator=(thread_pool const &);
+
+    bool take(size_t home, std::function<void()> &task);
+    void worker_loop(size_t index);
+
+    // queues[0] is the shared queue, queues[i] belongs to worker i.
+    std::vector<std::unique_ptr<task_queue> > queues;
+    std::vector<std::thread> threads;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<size_t> pending;
+    bool stopping;
+};
+
+// Tasks forked together and joined with wait(). The first exception thrown
+// by a task is rethrown from wait().
+class task_group
+{
+public:
+    explicit task_group(thread_pool &pool);
+    ~task_group();
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    task_group(task_group const &);
+    task_group &operator=(task_group const &);
+
+    thread_pool &pool;
+    std::atomic<size_t> outstanding;
+    std::mutex error_lock;
+    std::exception_ptr error;
+};
+
+// Runs tasks[0, count), spread over pool when it is not null, otherwise
+// one after another. The calling thread runs the last task itself.
+void run_all(thread_pool *pool, std::function<void()> const *tasks, size_t count);
+
+// Runs every function, forking all but the last onto pool when it is not
+// null. Without a pool they are called directly, with no std::function
+// wrapping.
+template <class F>
+void parallel_invoke(thread_pool *, F const &last)
+{
+    last();
+}
+
+template <class F, class... Rest>
+void parallel_invoke(thread_pool *pool, F const &first, Rest const &... rest)
+{
+    if (pool == 0)
+    {
+        first();
+        parallel_invoke(pool, rest...);
+        return;
+    }
+    task_group group(*pool);
+    group.run(first);
+    parallel_invoke(pool, rest...);
+    group.wait();
+}
+
+#endif //BIGINT_THREAD_POOL_H
@@ -4,33 +4,101 @@
 #include <vector>
 #include <iosfwd>
 #include <limits>
+#include <new>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
 #include <stdint.h>
+#include "limb_allocator.h"
 
-struct vector_with_opt
+// Reference count of a shared heap block. plain_link_count is for values
+// that never cross threads; atomic_link_count makes copying and releasing
+// shared values from several threads safe. Building with
+// BIGINT_THREAD_SAFE defined makes the atomic one the default.
+struct plain_link_count
 {
+    size_t value;
+
+    explicit plain_link_count(size_t v) : value(v) {}
+
+    bool shared() const
+    {
+        return value > 1;
+    }
+
+    void acquire()
+    {
+        ++value;
+    }
+
+    // True when the last reference is gone.
+    bool release()
+    {
+        return --value == 0;
+    }
+};
+
+struct atomic_link_count
+{
+    std::atomic<size_t> value;
+
+    explicit atomic_link_count(size_t v) : value(v) {}
+
+    // Acquire pairs with the release in release(), so an owner that sees
+    // itself as the only holder also sees every write made before the
+    // other holders let go.
+    bool shared() const
+    {
+        return value.load(std::memory_order_acquire) > 1;
+    }
+
+    // A new reference is always made from an existing one, so no ordering
+    // is needed here.
+    void acquire()
+    {
+        value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool release()
+    {
+        return value.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+};
+
+#ifdef BIGINT_THREAD_SAFE
+typedef atomic_link_count default_link_count;
+#else
+typedef plain_link_count default_link_count;
+#endif
+
+// Up to InlineLimbs limbs are stored inside the object. Longer values live
+// in one heap block: a vector_with_link header followed by the limbs,
+// shared copy-on-write between copies. A value's first block comes from
+// the thread's current_limb_allocator(), later ones from the allocator of
+// the block they replace, and every block goes back to the one it came
+// from. A block from a scoped allocator (one with an outer()) is never
+// shared or moved: copies and moves take the limbs to its outer().
+template <size_t InlineLimbs, class LinkCount = default_link_count>
+struct basic_vector_with_opt
+{
+    static_assert(InlineLimbs >= 1, "at least one limb must fit inline");
+
     struct vector_with_link
     {
-        std::vector<uint32_t> data;
-        size_t link_count;
+        LinkCount link_count;
+        size_t capacity;
+        limb_allocator *owner;
 
-        vector_with_link(uint32_t elem, size_t new_size)
-        {
-            data.resize(new_size);
-            data[0] = elem;
-            link_count = 1;
-        }
+        vector_with_link(size_t cap, limb_allocator *alloc) : link_count(1), capacity(cap), owner(alloc) {}
 
-        vector_with_link(uint32_t elem1, uint32_t elem2)
+        static size_t bytes(size_t capacity)
         {
-            data.push_back(elem1);
-            data.push_back(elem2);
-            link_count = 1;
+            return sizeof(vector_with_link) + capacity * sizeof(uint32_t);
         }
 
-        vector_with_link(std::vector<uint32_t> new_data)
+        uint32_t *limbs()
         {
-            data = new_data;
-            link_count = 1;
+            return reinterpret_cast<uint32_t *>(this + 1);
         }
     };
 
@@ -38,18 +106,31 @@ private:
     union
     {
         vector_with_link *big_object;
-        uint32_t small_obj;
+        uint32_t small_obj[InlineLimbs];
     };
     size_t v_size;
     bool is_big_obj;
+
+    static vector_with_link *allocate_block(size_t capacity, limb_allocator &alloc);
+    static void free_block(vector_with_link *block);
     void make_own_copy();
+    void leave_scope();
+    void reallocate(size_t capacity);
+    void make_small(size_t new_size);
     void safe_delete();
 
 public:
-    vector_with_opt();
-    ~vector_with_opt();
+    basic_vector_with_opt();
+    basic_vector_with_opt(basic_vector_with_opt const &other);
+    basic_vector_with_opt(basic_vector_with_opt &&other) noexcept;
+    ~basic_vector_with_opt();
 
-    vector_with_opt &operator=(vector_with_opt const &other);
+    basic_vector_with_opt &operator=(basic_vector_with_opt const &other);
+    basic_vector_with_opt &operator=(basic_vector_with_opt &&other) noexcept;
+    void swap(basic_vector_with_opt &other) noexcept;
+    // Replaces the contents with limbs[0, n), which must not point into this
+    // vector. An unshared block that is large enough is reused.
+    void assign(uint32_t const *limbs, size_t n);
     uint32_t& operator[](size_t index);
     uint32_t const& operator[](size_t index) const;
 
@@ -59,5 +140,330 @@ public:
     size_t size() const;
 
     uint32_t &back();
+    uint32_t const *data() const;
+
+    // Unshares the limbs once and returns them for direct writes. The
+    // pointer stays valid until the next call that changes the size or
+    // capacity, so hot loops can run on it without per-limb checks.
+    uint32_t *mutable_data();
+    // Unshares and makes room for new_capacity limbs without changing size.
+    void reserve(size_t new_capacity);
+    size_t capacity() const;
 };
+
+template <size_t InlineLimbs, class LinkCount>
+basic_vector_with_opt<InlineLimbs, LinkCount>::basic_vector_with_opt()
+{
+    is_big_obj = false;
+    v_size = 0;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+basic_vector_with_opt<InlineLimbs, LinkCount>::basic_vector_with_opt(basic_vector_with_opt const &other) : basic_vector_with_opt()
+{
+    *this = other;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+basic_vector_with_opt<InlineLimbs, LinkCount>::basic_vector_with_opt(basic_vector_with_opt &&other) noexcept : basic_vector_with_opt()
+{
+    swap(other);
+    if (is_big_obj)
+    {
+        leave_scope();
+    }
+}
+
+template <size_t InlineLimbs, class LinkCount>
+basic_vector_with_opt<InlineLimbs, LinkCount>::~basic_vector_with_opt()
+{
+    if (is_big_obj)
+    {
+        safe_delete();
+    }
+}
+
+template <size_t InlineLimbs, class LinkCount>
+basic_vector_with_opt<InlineLimbs, LinkCount> &basic_vector_with_opt<InlineLimbs, LinkCount>::operator=(basic_vector_with_opt const &other)
+{
+    if (this == &other)
+        return *this;
+
+    if (is_big_obj)
+    {
+        safe_delete();
+    }
+
+    if (!other.is_big_obj)
+    {
+        std::memcpy(small_obj, other.small_obj, other.v_size * sizeof(uint32_t));
+    }
+    else if (limb_allocator *outer = other.big_object->owner->outer())
+    {
+        // A scoped block may die before the copy does.
+        this->big_object = allocate_block(other.v_size, *outer);
+        std::memcpy(this->big_object->limbs(), other.big_object->limbs(), other.v_size * sizeof(uint32_t));
+    }
+    else
+    {
+        other.big_object->link_count.acquire();
+        this->big_object = other.big_object;
+    }
+    this->v_size = other.v_size;
+    this->is_big_obj = other.is_big_obj;
+    return *this;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+basic_vector_with_opt<InlineLimbs, LinkCount> &basic_vector_with_opt<InlineLimbs, LinkCount>::operator=(basic_vector_with_opt &&other) noexcept
+{
+    basic_vector_with_opt tmp(std::move(other));
+    swap(tmp);
+    return *this;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::swap(basic_vector_with_opt &other) noexcept
+{
+    if (is_big_obj && other.is_big_obj)
+    {
+        std::swap(big_object, other.big_object);
+    }
+    else if (is_big_obj || other.is_big_obj)
+    {
+        basic_vector_with_opt &big = is_big_obj ? *this : other;
+        basic_vector_with_opt &small = is_big_obj ? other : *this;
+        vector_with_link *buff = big.big_object;
+        std::memcpy(big.small_obj, small.small_obj, small.v_size * sizeof(uint32_t));
+        small.big_object = buff;
+    }
+    else
+    {
+        uint32_t buff[InlineLimbs];
+        std::memcpy(buff, small_obj, v_size * sizeof(uint32_t));
+        std::memcpy(small_obj, other.small_obj, other.v_size * sizeof(uint32_t));
+        std::memcpy(other.small_obj, buff, v_size * sizeof(uint32_t));
+    }
+    std::swap(v_size, other.v_size);
+    std::swap(is_big_obj, other.is_big_obj);
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::assign(uint32_t const *limbs, size_t n)
+{
+    // Anything else is dropped first, so the old limbs are never copied.
+    if (is_big_obj && (big_object->link_count.shared() || big_object->capacity < n))
+    {
+        resize(0);
+    }
+    resize(n);
+    if (n != 0)
+    {
+        std::memcpy(mutable_data(), limbs, n * sizeof(uint32_t));
+    }
+}
+
+template <size_t InlineLimbs, class LinkCount>
+uint32_t &basic_vector_with_opt<InlineLimbs, LinkCount>::operator[](size_t index)
+{
+    if (is_big_obj)
+    {
+        make_own_copy();
+        return big_object->limbs()[index];
+    }
+    return small_obj[index];
+}
+
+template <size_t InlineLimbs, class LinkCount>
+uint32_t const &basic_vector_with_opt<InlineLimbs, LinkCount>::operator[](size_t index) const
+{
+    return data()[index];
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::resize(size_t new_size)
+{
+    if (new_size <= InlineLimbs)
+    {
+        if (is_big_obj)
+        {
+            make_small(std::min(v_size, new_size));
+        }
+        if (new_size > v_size)
+        {
+            std::fill(small_obj + v_size, small_obj + new_size, 0);
+        }
+        v_size = new_size;
+        return;
+    }
+
+    if (is_big_obj && new_size <= v_size)
+    {
+        v_size = new_size;
+        return;
+    }
+
+    reserve(new_size);
+    uint32_t *limbs = big_object->limbs();
+    std::fill(limbs + v_size, limbs + new_size, 0);
+    v_size = new_size;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::push_back(uint32_t elem)
+{
+    if (!is_big_obj && v_size < InlineLimbs)
+    {
+        small_obj[v_size++] = elem;
+        return;
+    }
+
+    if (!is_big_obj || big_object->link_count.shared() || big_object->capacity == v_size)
+    {
+        reallocate(std::max(2 * v_size, is_big_obj ? big_object->capacity : 0));
+    }
+    big_object->limbs()[v_size++] = elem;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::pop_back()
+{
+    size_t new_size = v_size - 1;
+    if (is_big_obj && new_size <= InlineLimbs)
+    {
+        make_small(new_size);
+    }
+    v_size = new_size;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+size_t basic_vector_with_opt<InlineLimbs, LinkCount>::size() const
+{
+    return v_size;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+uint32_t &basic_vector_with_opt<InlineLimbs, LinkCount>::back()
+{
+    return (*this)[v_size - 1];
+}
+
+template <size_t InlineLimbs, class LinkCount>
+uint32_t const *basic_vector_with_opt<InlineLimbs, LinkCount>::data() const
+{
+    if (is_big_obj) return big_object->limbs();
+    return small_obj;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+uint32_t *basic_vector_with_opt<InlineLimbs, LinkCount>::mutable_data()
+{
+    if (is_big_obj)
+    {
+        make_own_copy();
+        return big_object->limbs();
+    }
+    return small_obj;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::reserve(size_t new_capacity)
+{
+    if (is_big_obj)
+    {
+        if (big_object->link_count.shared() || big_object->capacity < new_capacity)
+        {
+            reallocate(std::max(new_capacity, big_object->capacity));
+        }
+    }
+    else if (new_capacity > InlineLimbs)
+    {
+        reallocate(new_capacity);
+    }
+}
+
+template <size_t InlineLimbs, class LinkCount>
+size_t basic_vector_with_opt<InlineLimbs, LinkCount>::capacity() const
+{
+    return is_big_obj ? big_object->capacity : InlineLimbs;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+typename basic_vector_with_opt<InlineLimbs, LinkCount>::vector_with_link *
+basic_vector_with_opt<InlineLimbs, LinkCount>::allocate_block(size_t capacity, limb_allocator &alloc)
+{
+    void *mem = alloc.allocate(vector_with_link::bytes(capacity));
+    return new (mem) vector_with_link(capacity, &alloc);
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::free_block(vector_with_link *block)
+{
+    limb_allocator *owner = block->owner;
+    size_t bytes = vector_with_link::bytes(block->capacity);
+    block->~vector_with_link();
+    owner->deallocate(block, bytes);
+}
+
+// Moves the limbs into a fresh unshared block of the given capacity, from
+// the old block's allocator unless that one is scoped.
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::reallocate(size_t capacity)
+{
+    bool keep = is_big_obj && big_object->owner->outer() == 0;
+    vector_with_link *new_v = allocate_block(capacity, keep ? *big_object->owner : current_limb_allocator());
+    std::memcpy(new_v->limbs(), data(), v_size * sizeof(uint32_t));
+    if (is_big_obj)
+    {
+        safe_delete();
+    }
+    big_object = new_v;
+    is_big_obj = true;
+}
+
+// Moves the first new_size limbs back inline and releases the block.
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::make_small(size_t new_size)
+{
+    uint32_t buff[InlineLimbs];
+    std::memcpy(buff, big_object->limbs(), new_size * sizeof(uint32_t));
+    safe_delete();
+    std::memcpy(small_obj, buff, new_size * sizeof(uint32_t));
+    is_big_obj = false;
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::safe_delete()
+{
+    if (big_object->link_count.release())
+    {
+        free_block(big_object);
+    }
+}
+
+// Puts limbs held in a scoped allocator's block onto its outer() instead.
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::leave_scope()
+{
+    if (limb_allocator *outer = big_object->owner->outer())
+    {
+        vector_with_link *new_v = allocate_block(big_object->capacity, *outer);
+        std::memcpy(new_v->limbs(), big_object->limbs(), v_size * sizeof(uint32_t));
+        safe_delete();
+        big_object = new_v;
+    }
+}
+
+template <size_t InlineLimbs, class LinkCount>
+void basic_vector_with_opt<InlineLimbs, LinkCount>::make_own_copy()
+{
+    if (big_object->link_count.shared())
+    {
+        reallocate(big_object->capacity);
+    }
+}
+
+extern template struct basic_vector_with_opt<8>;
+typedef basic_vector_with_opt<8> vector_with_opt;
+
 #endif //BIGINT_OPT_VECTOR_H